@@ -0,0 +1,40 @@
+#include <iostream>
+#include <cassert>
+
+#include "rencpp/ren.hpp"
+
+using namespace ren;
+
+int main(int, char **) {
+    ValueArray array {3};
+    assert(array.empty());
+
+    array.push_back(10);
+    array.push_back(Block {"a b c"});
+    array.push_back(String {"foo"});
+
+    assert(array.size() == 3);
+    assert(array[0].isEqualTo(10));
+    assert(array[1].isBlock());
+    assert(array[2].isEqualTo(String {"foo"}));
+
+    // The block shares its cells with the array
+    Block block = array.toBlock();
+    assert(block.isEqualTo(Block {10, Block {"a b c"}, String {"foo"}}));
+
+    // Applying passes the cells through as the arguments
+    ValueArray args;
+    args.push_back(Block {1, 2, 3});
+    Value first {runtime(":first")};
+    assert(first.apply(args).isEqualTo(1));
+    assert(first(args).isEqualTo(1));
+
+    // Growing past the initial capacity keeps everything
+    for (int i = 0; i < 1000; i++)
+        args.push_back(Block {i});
+    assert(args.size() == 1001);
+    assert(args[1000].isEqualTo(Block {999}));
+
+    args.clear();
+    assert(args.empty());
+}
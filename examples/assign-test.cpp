@@ -1,4 +1,8 @@
 #include <iostream>
+#include <cassert>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "rencpp/ren.hpp"
 
@@ -15,4 +19,26 @@ int main(int, char **) {
     Block someOtherBlock {20, "bar"};
 
     someBlock = someOtherBlock;
+
+    // Assigning a series to itself must not drop its last reference
+    someBlock = someBlock;
+    assert(someBlock.isEqualTo(Block {20, "bar"}));
+
+    // Moves hand the reference over and leave the source empty of one
+    static_assert(
+        std::is_nothrow_move_constructible<Block>::value
+        and std::is_nothrow_move_assignable<Block>::value,
+        "Block moves should be noexcept"
+    );
+
+    Block movedBlock {std::move(someBlock)};
+    assert(movedBlock.isEqualTo(someOtherBlock));
+
+    someValue = std::move(movedBlock);
+    assert(someValue.isEqualTo(someOtherBlock));
+
+    std::vector<Block> blocks;
+    for (int i = 0; i < 100; i++)
+        blocks.push_back(Block {i});
+    assert(blocks[99].isEqualTo(Block {99}));
 }
@@ -0,0 +1,44 @@
+#include <iostream>
+#include <cassert>
+
+#include "rencpp/ren.hpp"
+
+using namespace ren;
+
+int main(int, char **) {
+    Block data {1, 2, 3};
+
+    auto results = runtime.evaluateBatch({
+        {"first", data},
+        {"1 + 2"},
+        {"first []", "+ 1"}, // error: adding to none
+        {"append", data, 4}
+    });
+
+    assert(results.size() == 4);
+
+    assert(results[0].succeeded());
+    assert(results[0].get().isEqualTo(1));
+
+    assert(results[1].get().isEqualTo(3));
+
+    // A failed evaluation doesn't stop the ones after it
+
+    assert(not results[2].succeeded());
+    assert(results[2].error().isError());
+
+    try {
+        results[2].get();
+        throw std::runtime_error(
+            "FAILURE: get() of a failed batch result should throw"
+        );
+    }
+    catch (evaluation_error const &) {
+        std::cout << "SUCCESS: failed batch result throws on get()\n";
+    }
+
+    assert(results[3].succeeded());
+    assert(data.length() == 4);
+
+    std::cout << "SUCCESS: batch evaluation!\n";
+}
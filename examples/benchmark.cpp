@@ -0,0 +1,378 @@
+#include <iostream>
+#include <chrono>
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "rencpp/ren.hpp"
+
+using namespace ren;
+
+//
+// Not a test so much as a way to get numbers for the hot paths of the
+// binding.  Build it in release mode if you want the numbers to mean much.
+//
+
+namespace {
+
+template <typename F>
+double timeIt(char const * label, int iterations, F && f) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+        f(i);
+    auto stop = std::chrono::steady_clock::now();
+
+    double nsPer =
+        std::chrono::duration<double, std::nano>(stop - start).count()
+        / iterations;
+
+    std::cout << label << ": " << nsPer << " ns/iteration" << std::endl;
+    return nsPer;
+}
+
+
+//
+// Series handles each need a reference count.  After a warmup the pool
+// should have all the slots it needs, and the churn should not grow it.
+//
+
+void benchmarkRefcounts() {
+    Block blk {"1 2 3 4 5 6 7 8 9 10"};
+
+    auto churn = [&blk](int) {
+        Block copies[8] {blk, blk, blk, blk, blk, blk, blk, blk};
+        for (auto item : blk)
+            static_cast<void>(item);
+        Block fresh {blk};
+        static_cast<void>(copies);
+    };
+
+    timeIt("refcount warmup", 1000, churn);
+    size_t slabs = internal::RefcountPool::slabsAllocated();
+
+    timeIt("series handle churn", 100000, churn);
+    if (internal::RefcountPool::slabsAllocated() != slabs)
+        throw std::runtime_error(
+            "FAILURE: refcount pool kept growing after the warmup"
+        );
+
+    std::cout << "refcount slabs allocated: " << slabs << std::endl;
+
+    // Dropped handles are released to the runtime in batches, so some may
+    // still be waiting for the next evaluation
+    std::cout << "releases pending: "
+        << internal::ReleaseQueue::pending(Engine::runFinder().getHandle())
+        << std::endl;
+}
+
+
+//
+// Iterators hold a Series copy and hand back Values that may be series, so
+// walking a block is a good measure of what each count bump costs.  Compare
+// builds with REFCOUNT_THREADSAFE on and off.
+//
+
+void benchmarkIteration() {
+    std::string source;
+    for (int i = 0; i < 100; i++)
+        source += "[" + std::to_string(i) + " " + std::to_string(i + 1) + "] ";
+    Block blk {source.c_str()};
+
+    timeIt("iterate 100 nested blocks", 10000, [&blk](int) {
+        for (auto item : blk)
+            static_cast<void>(item);
+    });
+}
+
+
+//
+// Applying a function copies its series arguments into the loadables and
+// hands back a fresh series value.
+//
+
+void benchmarkApply() {
+    Block blk {"[a b] [c d] [e f]"};
+    Value first {runtime(":first")};
+
+    timeIt("apply with a series argument", 10000, [&](int) {
+        Value result = first(blk);
+        static_cast<void>(result);
+    });
+
+    // A temporary passed in gives its reference to the call rather than
+    // being copied into it
+    timeIt("apply with a temporary series", 10000, [&](int) {
+        Value result = first(Block {1, 2, 3});
+        static_cast<void>(result);
+    });
+}
+
+
+//
+// Casting a Value to a more specific class makes a new handle, where as<T>()
+// just checks the type and borrows the cell.
+//
+
+void benchmarkCasts() {
+    Value blk {Block {"1 2 3"}};
+
+    timeIt("static_cast<Block> of a series", 1000000, [&blk](int) {
+        Block cast = static_cast<Block>(blk);
+        static_cast<void>(cast);
+    });
+
+    timeIt("as<Block>() of a series", 1000000, [&blk](int) {
+        Ref<Block> view = blk.as<Block>();
+        static_cast<void>(view);
+    });
+}
+
+
+//
+// Constructing from one loadable, or applying to cells that are already
+// loaded, shouldn't have to make a new block each time.  The memory the
+// runtime reports in use is shown too, as growth there means more work
+// for its garbage collector.
+//
+
+void benchmarkSingleValues() {
+    Value add {runtime(":add")};
+    Integer one {1};
+    Integer two {2};
+
+    auto memoryInUse = []() -> int {
+    #if REN_RUNTIME == REN_RUNTIME_REBOL
+        return static_cast<int>(static_cast<Integer>(runtime("stats")));
+    #else
+        return 0;
+    #endif
+    };
+
+    int before = memoryInUse();
+
+    timeIt("construct Word from one token", 100000, [](int) {
+        Word word {"foo"};
+        static_cast<void>(word);
+    });
+
+    timeIt("apply to loaded cells", 100000, [&](int) {
+        Value result = add(one, two);
+        static_cast<void>(result);
+    });
+
+    std::cout << "runtime memory growth: "
+        << (memoryInUse() - before) << " bytes" << std::endl;
+}
+
+
+//
+// Loading the same text over and over should be served from the scan cache
+// after the first time, leaving only a copy of the cached block.
+//
+
+void benchmarkRepeatedLoads() {
+    timeIt("load repeated text", 100000, [](int) {
+        Block code {"either result: parse data rule [a] [b]"};
+        static_cast<void>(code);
+    });
+
+    // REN() skips hashing and looking up the text, and the deep copy
+    timeIt("load repeated REN() literal", 100000, [](int) {
+        Block code {REN("either result: parse data rule [a] [b]")};
+        static_cast<void>(code);
+    });
+
+#if REN_RUNTIME == REN_RUNTIME_REBOL
+    auto stats = runtime.scanCacheStats();
+    std::cout << "scan cache: " << stats.hits << " hits, "
+        << stats.misses << " misses, "
+        << stats.entries << " entries" << std::endl;
+#endif
+}
+
+
+//
+// A Prepared scans and binds its code once, where passing the same text to
+// runtime(...) has to at least look it up and copy it every time.
+//
+
+void benchmarkPrepared() {
+    Block data {};
+
+    timeIt("runtime(\"append\", data, ...)", 100000, [&data](int i) {
+        runtime("append", data, Integer {i});
+    });
+
+    data = Block {};
+    Prepared appender {"append", placeholders::_1, placeholders::_2};
+
+    timeIt("Prepared append", 100000, [&](int i) {
+        appender(data, Integer {i});
+    });
+}
+
+
+//
+// Function::call() with value arguments puts them straight into the frame,
+// where evaluating source text has to load and bind it first.
+//
+
+void benchmarkCall() {
+    auto add = static_cast<Function>(
+        runtime("func [a [integer!] b [integer!]] [a + b]")
+    );
+    runtime("add-it:", add);
+
+    timeIt("runtime(\"add-it\", ...)", 100000, [](int i) {
+        Value result = runtime("add-it", Integer {i}, Integer {1});
+        static_cast<void>(result);
+    });
+
+    timeIt("add.call(...)", 100000, [&add](int i) {
+        Value result = add.call(Integer {i}, Integer {1});
+        static_cast<void>(result);
+    });
+}
+
+
+//
+// A big data file loaded through a std::string is copied twice and measured
+// before it's scanned, where loadFile scans the mapped file in place.
+//
+
+void benchmarkLoadFile() {
+    char const * path = "benchmark-data.ren";
+    {
+        std::ofstream out (path);
+        for (int i = 0; i < 100000; i++)
+            out << "[" << i << " \"item\" " << i * 0.5 << "]\n";
+    }
+
+    timeIt("load file through std::string", 10, [path](int) {
+        std::ifstream in (path);
+        std::stringstream text;
+        text << in.rdbuf();
+        Block loaded {text.str()};
+        static_cast<void>(loaded);
+    });
+
+    LoadTimings timings;
+    timeIt("runtime.loadFile", 10, [path, &timings](int) {
+        Block loaded = runtime.loadFile(path, nullptr, &timings);
+        static_cast<void>(loaded);
+    });
+
+    std::cout << "  last load: map " << timings.map.count()
+        << " ns, scan " << timings.scan.count()
+        << " ns, bind " << timings.bind.count() << " ns" << std::endl;
+
+    std::remove(path);
+}
+
+
+//
+// Forming a big block should mold it once, however long the text is.
+//
+
+void benchmarkForm() {
+    // Formed in C++, without calling into the runtime
+    timeIt("to_string of an Integer and a Float", 1000000, [](int i) {
+        std::string intText = to_string(Integer {i});
+        std::string floatText = to_string(Float {i * 0.5});
+        static_cast<void>(intText);
+        static_cast<void>(floatText);
+    });
+
+    Block data {};
+    for (int i = 0; i < 1000; i++)
+        runtime("append", data, Block {i, "item", i * 0.5});
+
+    timeIt("to_string of a large block", 1000, [&data](int) {
+        std::string text = to_string(data);
+        static_cast<void>(text);
+    });
+
+    // Streamed, nothing the size of the text is allocated on the C++ side
+    timeIt("formTo of a large block", 1000, [&data](int) {
+        size_t total = 0;
+        formTo(
+            [&total](char const *, size_t numBytes) { total += numBytes; },
+            data
+        );
+        static_cast<void>(total);
+    });
+
+    // Only the start is formed, however big the block is
+    timeIt("to_string of the first 80 bytes of a large block", 1000,
+        [&data](int) {
+            std::string text = to_string(data, 80);
+            static_cast<void>(text);
+        }
+    );
+}
+
+
+//
+// Running small evaluations as a batch sets the runtime up for them once,
+// rather than once per call.
+//
+
+void benchmarkBatch() {
+    Block data {1, 2, 3};
+
+    timeIt("8 separate evaluations", 10000, [&data](int) {
+        for (int i = 0; i < 8; i++) {
+            Value result = runtime("first", data);
+            static_cast<void>(result);
+        }
+    });
+
+    timeIt("8 evaluations in a batch", 10000, [&data](int) {
+        auto results = runtime.evaluateBatch({
+            {"first", data}, {"first", data}, {"first", data},
+            {"first", data}, {"first", data}, {"first", data},
+            {"first", data}, {"first", data}
+        });
+        static_cast<void>(results);
+    });
+}
+
+
+//
+// Immediates shouldn't need the engine finder or a reference count, so
+// marshaling numbers should cost about as much as filling in the cell.
+//
+
+void benchmarkImmediates() {
+    timeIt("construct Integer and Float", 1000000, [](int i) {
+        Integer someInt {i};
+        Float someFloat {i * 0.5};
+        static_cast<void>(someInt);
+        static_cast<void>(someFloat);
+    });
+}
+
+} // end anonymous namespace
+
+
+int main(int, char **) {
+    std::cout << "refcount policy: "
+        << (REN_REFCOUNT_THREADSAFE ? "atomic" : "single-threaded")
+        << std::endl;
+
+    benchmarkImmediates();
+    benchmarkRefcounts();
+    benchmarkIteration();
+    benchmarkCasts();
+    benchmarkApply();
+    benchmarkSingleValues();
+    benchmarkRepeatedLoads();
+    benchmarkPrepared();
+    benchmarkCall();
+    benchmarkLoadFile();
+    benchmarkForm();
+    benchmarkBatch();
+}
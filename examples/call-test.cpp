@@ -0,0 +1,54 @@
+#include <iostream>
+#include <cassert>
+
+#include "rencpp/ren.hpp"
+
+using namespace ren;
+
+int main(int, char **) {
+    auto add = static_cast<Function>(
+        runtime("func [a [integer!] b [integer!]] [a + b]")
+    );
+
+    assert(add.call(1, 2).isEqualTo(3));
+    assert(add.call(Integer {10}, Integer {20}).isEqualTo(30));
+
+    // Natives get their arguments directly too
+    auto first = static_cast<Function>(runtime(":first"));
+    assert(first.call(Block {1, 2, 3}).isEqualTo(1));
+
+    // Arguments aren't evaluated, so a word is received as a word
+    auto typeOf = static_cast<Function>(runtime(":type?"));
+    assert(typeOf.call(Word {"foo"}).isEqualTo(runtime("word!")));
+
+    // Missing arguments are none, which the spec may not allow
+    try {
+        add.call(1);
+        assert(false);
+    }
+    catch (evaluation_error const & e) {
+        print("none is not an integer!");
+    }
+
+    try {
+        add.call(1, 2, 3);
+        assert(false);
+    }
+    catch (evaluation_error const & e) {
+        print("3 is too many arguments for a 2 argument function");
+    }
+
+    try {
+        add.call(1, String {"two"});
+        assert(false);
+    }
+    catch (evaluation_error const & e) {
+        print("a string! is not an integer!");
+    }
+
+    // An error shouldn't leave anything behind to break the next call
+    assert(add.call(4, 5).isEqualTo(9));
+
+    // Calls can nest, as when a function calls back out to C++
+    assert(add.call(add.call(1, 2), add.call(3, 4)).isEqualTo(10));
+}
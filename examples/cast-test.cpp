@@ -37,4 +37,34 @@ int main(int, char **) {
         std::cout << "SUCCESS: cast int to float threw bad_cast exception!\n";
 
     }
+
+    // Viewing rather than casting borrows the value's cell
+
+    Ref<Integer> intView = someIntAsValue.as<Integer>();
+    assert(intView->isEqualTo(someIntAsValue));
+    assert(static_cast<int>(Integer {intView}) == 10);
+
+    try {
+        someIntAsValue.as<Float>();
+
+        throw std::runtime_error(
+            "FAILURE: int shouldn't be viewable as float"
+        );
+    }
+    catch (std::bad_cast const & e) {
+
+        std::cout << "SUCCESS: view int as float threw bad_cast exception!\n";
+
+    }
+
+    Block blk {"foo", 1020};
+    Value blkAsValue = blk;
+
+    Ref<AnyBlock> blkView = blkAsValue.as<AnyBlock>();
+    assert(blkView->length() == 2);
+
+    if (blkAsValue.kind() == Kind::Block)
+        assert(blkAsValue.unchecked<Block>()->length() == 2);
+
+    std::cout << "SUCCESS: views with as<T>() and unchecked<T>()!\n";
 }
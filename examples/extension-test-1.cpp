@@ -1,4 +1,5 @@
 #include <iostream>
+#include <cassert>
 #include <string>
 
 #include "rencpp/ren.hpp"
@@ -29,4 +30,37 @@ int main(int, char **) {
     // Call the extension under its new name
 
     runtime("some-ext [1 2 3]");
+
+    // Parameters can also be borrowed views of the stack cells, which cost
+    // no reference counting; they promote to owning values when needed
+
+    Function sumBlock = makeFunction(
+        "{Sum a block of integers without owning its elements}"
+        "blk [block!] {The block to sum}",
+
+        REN_STD_FUNCTION,
+
+        [](BlockRef blk) -> Integer {
+            // The iterators hold the block, but the elements are only
+            // borrowed, so nothing joins the queue while walking them
+            RenEngineHandle engine = Engine::runFinder().getHandle();
+            auto it = blk->begin();
+            auto end = blk->end();
+            size_t pending = internal::ReleaseQueue::pending(engine);
+
+            int sum = 0;
+            for (; it != end; ++it) {
+                ValueRef item = it.ref();
+                assert(item->isInteger());
+                sum += Integer {item->as<Integer>()};
+                assert(internal::ReleaseQueue::pending(engine) == pending);
+            }
+
+            return sum;
+        }
+    );
+
+    runtime("sum-ext: quote", sumBlock);
+
+    assert(runtime("sum-ext [1 2 3]").isEqualTo(6));
 }
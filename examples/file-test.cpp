@@ -0,0 +1,59 @@
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+#include "rencpp/ren.hpp"
+
+using namespace ren;
+
+int main(int, char **) {
+    char const * path = "file-test-data.ren";
+
+    {
+        std::ofstream out (path);
+        out << "x: 10\n";
+        out << "data: [1 2 3]\n";
+        out << "x + length? data";
+    }
+
+    Block loaded = runtime.loadFile(path);
+    assert(loaded.length() == 8);
+    assert(loaded[2].isEqualTo(10));
+
+    LoadTimings timings;
+    Value result = runtime.evaluateFile(path, nullptr, &timings);
+    assert(result.isEqualTo(13));
+    assert(timings.map.count() >= 0);
+    assert(timings.scan.count() >= 0);
+    assert(timings.bind.count() >= 0);
+
+    // A file that's a whole number of pages long doesn't end in the zero
+    // fill of a mapping, and has to be read instead
+    {
+        std::ofstream out (path);
+        out << "size: 4096";
+        for (int i = 10; i < 4096; i++)
+            out << ' ';
+    }
+
+    assert(runtime.evaluateFile(path).isEqualTo(4096));
+
+    // An empty file loads as an empty block
+    {
+        std::ofstream out (path);
+    }
+
+    assert(runtime.loadFile(path).length() == 0);
+
+    std::remove(path);
+
+    try {
+        runtime.loadFile("no-such-file.ren");
+        assert(false);
+    }
+    catch (std::runtime_error const & e) {
+        print("missing file is a runtime_error");
+    }
+}
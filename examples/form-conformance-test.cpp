@@ -0,0 +1,121 @@
+#include <iostream>
+#include <cassert>
+#include <clocale>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "rencpp/ren.hpp"
+
+using namespace ren;
+
+//
+// Integers, floats, logic, none, and characters are formed in C++ instead
+// of by the runtime.  Each is checked here against what FORM in the runtime
+// gives for the same value, which comes back as a string and is formed by
+// the runtime as usual.
+//
+
+namespace {
+
+int numChecked = 0;
+
+void check(Value const & value) {
+    std::string native = to_string(value);
+    std::string formed = to_string(runtime("form", value));
+
+    if (native != formed) {
+        std::cout << "FORM mismatch: native \"" << native
+            << "\" vs. runtime \"" << formed << "\"" << std::endl;
+        assert(false);
+    }
+
+    numChecked++;
+}
+
+
+double fromBits(uint64_t bits) {
+    double d;
+    std::memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+
+char const * const commaLocales[] = {
+    "de_DE.UTF-8", "de_DE.utf8", "fr_FR.UTF-8", "fr_FR.utf8", "de_DE"
+};
+
+} // end anonymous namespace
+
+
+int main(int, char **) {
+    check(Value {none});
+    check(Value {true});
+    check(Value {false});
+
+    // Integers, including the ends of the 64-bit range, which can't be made
+    // from a C++ int
+    for (int i : {0, 1, -1, 9, 10, -10, 99, 100, 12345, -2147483647 - 1})
+        check(Value {i});
+    check(runtime("9223372036854775807"));
+    check(runtime("-9223372036854775807 - 1"));
+    check(runtime("10000000000"));
+
+    // Floats around each place the layout changes: whole numbers, the edge
+    // of the 15 digits shown, and the small and large exponent forms
+    std::vector<double> floats {
+        0.0, 1.0, -1.0, 0.5, -1.5, 0.1, 0.2 + 0.1, 1.0 / 3.0, 2.0 / 3.0,
+        10.0, 100.0, 12345.678, 123456789012345.0, 1234567890123456.0,
+        1e14, 1e15, 1e16, 1e20, 1.5e20, -2.5e100, 1e300,
+        1.7976931348623157e308, 2.2250738585072014e-308, 5e-324,
+        1e-5, 1e-6, 1.5e-6, 1e-7, 1.5e-7, 1e-8, 0.000123, 0.00000123
+    };
+
+    // Then a deterministic spread of bit patterns, skipping the ones that
+    // aren't finite
+    uint64_t state = 88172645463325252ULL;
+    for (int i = 0; i < 10000; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+
+        double d = fromBits(state);
+        if (d == d and d - d == 0)
+            floats.push_back(d);
+    }
+
+    // And numbers with few digits, which is what most floats really are
+    for (int i = -2000; i <= 2000; i += 7) {
+        floats.push_back(i / 8.0);
+        floats.push_back(i / 1000.0);
+        floats.push_back(i * 1e9);
+    }
+
+    for (double d : floats)
+        check(Value {d});
+
+    // printf follows the locale's radix, which the native form mustn't (the
+    // Qt workbench sets the locale from the environment).  Not every system
+    // has a locale that uses a comma, so this is skipped if none is found.
+    for (char const * name : commaLocales) {
+        if (not std::setlocale(LC_NUMERIC, name))
+            continue;
+        if (std::localeconv()->decimal_point[0] != ',')
+            continue;
+
+        for (double d : floats)
+            check(Value {d});
+        break;
+    }
+    std::setlocale(LC_NUMERIC, "C");
+
+    // Characters, with one of each UTF-8 length the runtime can hold
+    std::vector<wchar_t> characters {
+        L'a', L' ', L'"', L'^', L'{', L'\x7F', L'\x444', L'\x20AC'
+    };
+    for (wchar_t c : characters)
+        check(Value {c});
+
+    std::cout << numChecked << " forms matched the runtime" << std::endl;
+}
@@ -1,6 +1,9 @@
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <cassert>
+#include <iterator>
+#include <vector>
 
 #include "rencpp/ren.hpp"
 
@@ -23,4 +26,55 @@ int main(int, char **) {
     // Yes, not a test suite, but one test is better than zero.
     assert(String {"\n\t\u0444"}.isEqualTo("\n\t\u0444"));
     assert(String {"^/^-^(0444)"}.isEqualTo("\n\t\u0444"));
+
+    // Text far longer than any starting buffer comes out whole, and the
+    // same whether it goes to a string or a stream
+    std::string longText (100000, 'x');
+    longText += "\u0444";
+    String longString {longText};
+    assert(to_string(longString) == longText);
+
+    std::stringstream ss;
+    ss << longString;
+    assert(ss.str() == longText);
+
+    // Streamed forming gives the same bytes, in pieces
+    size_t numPieces = 0;
+    std::string gathered;
+    formTo(
+        [&](char const * data, size_t numBytes) {
+            numPieces++;
+            gathered.append(data, numBytes);
+        },
+        longString
+    );
+    assert(gathered == longText);
+    assert(numPieces >= 1);
+
+    std::vector<char> out;
+    format_to(std::back_inserter(out), Value {10});
+    assert(std::string (out.begin(), out.end()) == "10");
+
+    // A bounded form gives a prefix of the whole, cut between characters,
+    // and says whether anything was left off
+    bool truncated = false;
+    std::string prefix = to_string(longString, 100, &truncated);
+    assert(truncated);
+    assert(prefix == longText.substr(0, 100));
+
+    prefix = to_string(longString, 100001, &truncated);
+    assert(truncated);
+    assert(prefix == longText.substr(0, 100000)); // no half of the \u0444
+
+    prefix = to_string(longString, longText.size(), &truncated);
+    assert(not truncated);
+    assert(prefix == longText);
+
+    Block nested {1, Block {"two", 3}, 4};
+    std::string whole = to_string(nested);
+    for (size_t limit = 0; limit <= whole.size() + 1; limit++) {
+        prefix = to_string(nested, limit, &truncated);
+        assert(prefix == whole.substr(0, limit));
+        assert(truncated == (limit < whole.size()));
+    }
 }
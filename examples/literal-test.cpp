@@ -0,0 +1,49 @@
+#include <iostream>
+#include <cassert>
+
+#include "rencpp/ren.hpp"
+
+using namespace ren;
+
+// The checks are constant expressions, so they can be tested as such
+
+static_assert(internal::isBalancedSource("print [x (y + 1)]"), "");
+static_assert(internal::isBalancedSource("{nested {braces} ^}} \"s^\"\""), "");
+static_assert(internal::isBalancedSource("; a comment with a [\nx"), "");
+static_assert(internal::isBalancedSource("#\"[\""), "");
+static_assert(not internal::isBalancedSource("print [x"), "");
+static_assert(not internal::isBalancedSource("print [x)"), "");
+static_assert(not internal::isBalancedSource("x]"), "");
+static_assert(not internal::isBalancedSource("\"unclosed"), "");
+static_assert(not internal::isBalancedSource("{unclosed"), "");
+
+// Long fragments don't recurse a level per character (this one is over
+// 2500 characters, well past the default -fconstexpr-depth of 512)
+
+#define LITERAL_PIECE "print [x (y + 1)] {b ^} s} \"q^\"\" ; c [\n"
+#define LITERAL_PIECE_4 LITERAL_PIECE LITERAL_PIECE LITERAL_PIECE LITERAL_PIECE
+#define LITERAL_PIECE_16 \
+    LITERAL_PIECE_4 LITERAL_PIECE_4 LITERAL_PIECE_4 LITERAL_PIECE_4
+#define LITERAL_PIECE_64 \
+    LITERAL_PIECE_16 LITERAL_PIECE_16 LITERAL_PIECE_16 LITERAL_PIECE_16
+
+static_assert(internal::isBalancedSource(LITERAL_PIECE_64), "");
+static_assert(not internal::isBalancedSource(LITERAL_PIECE_64 "]"), "");
+
+
+int main(int, char **) {
+    runtime("x: 10");
+
+    for (int i = 0; i < 3; i++) {
+        // Scanned on the first time through only
+        Value result = runtime(REN("x + 1"));
+        assert(result.isEqualTo(11));
+
+        // Spliced in with other loadables around it
+        result = runtime(REN("either"), i == 1, "[1]", REN("[2]"));
+        assert(result.isEqualTo(i == 1 ? 1 : 2));
+    }
+
+    Block block {REN("a b"), 10, "c"};
+    assert(block.isEqualTo(Block {"a b 10 c"}));
+}
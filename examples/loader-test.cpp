@@ -0,0 +1,56 @@
+#include <iostream>
+#include <cassert>
+#include <sstream>
+#include <string>
+
+#include "rencpp/ren.hpp"
+
+using namespace ren;
+
+int main(int, char **) {
+    // Values that cross chunk boundaries, with brackets and line breaks in
+    // strings and comments that mustn't be taken for top-level boundaries
+    std::string text =
+        "[1 2 3]\n"
+        "[\n    nested [a b]\n    (c d)\n]\n"
+        "\"a [string\" {braced\n[text] ^} here}\n"
+        "; a comment with a [ in it\n"
+        "word #\"[\" %file\n"
+        "[last]";
+
+    Block whole {text};
+
+    // Tiny chunks, so nearly every value spans more than one
+    for (size_t chunkSize : {1u, 3u, 7u, 64u}) {
+        std::istringstream in (text);
+        Loader loader {in, nullptr, chunkSize};
+
+        size_t index = 0;
+        Value value;
+        while (loader.next(value)) {
+            index++;
+            assert(value.isEqualTo(whole[index]));
+        }
+        assert(index == whole.length());
+    }
+
+    // Each chunk holds only complete values
+    std::istringstream in (text);
+    Loader loader {in, nullptr, 16};
+
+    size_t total = 0;
+    Block chunk;
+    while (loader.nextChunk(chunk)) {
+        for (auto item : chunk) {
+            static_cast<void>(item);
+            total++;
+        }
+    }
+    assert(total == whole.length());
+
+    // Empty input has nothing in it
+    std::istringstream empty;
+    Loader emptyLoader {empty};
+    Value value;
+    assert(not emptyLoader.next(value));
+}
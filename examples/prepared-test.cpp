@@ -0,0 +1,44 @@
+#include <iostream>
+#include <cassert>
+
+#include "rencpp/ren.hpp"
+
+using namespace ren;
+using namespace ren::placeholders;
+
+int main(int, char **) {
+    Prepared appender {"append", _1, "reduce", _2};
+    assert(appender.getArity() == 2);
+
+    Block data {};
+    appender(data, Block {"1 + 2"});
+    appender(data, Block {"10 * 2"});
+
+    assert(data.isEqualTo(Block {3, 20}));
+
+    // The same slot may be used more than once, and in any order
+
+    Prepared adder {"add", _2, _1, "+", _1};
+    assert(adder(Integer {1}, Integer {10}).isEqualTo(12));
+    assert(adder(Integer {2}, Integer {10}).isEqualTo(14));
+
+    // The failure is raised outside the try, so it can't be mistaken for
+    // the error the arity check throws
+
+    bool arityChecked = false;
+    try {
+        adder(Integer {1});
+    }
+    catch (std::runtime_error const &) {
+        arityChecked = true;
+    }
+
+    if (not arityChecked)
+        throw std::runtime_error(
+            "FAILURE: Prepared called with too few arguments"
+        );
+
+    std::cout << "SUCCESS: Prepared arity is checked!\n";
+
+    std::cout << "SUCCESS: Prepared evaluations!\n";
+}
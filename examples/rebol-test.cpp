@@ -1,9 +1,36 @@
 // We only do this if we've built for Rebol
 
+#include <cassert>
+
 #include "rencpp/rebol.hpp"
+#include "rencpp/ren.hpp"
 
 using namespace rebol;
 
 int main (int, char**) {
     runtime.doMagicOnlyRebolCanDo();
+
+    // Loading the same text again should come from the scan cache, and
+    // each load should get its own copy to modify
+
+    auto before = runtime.scanCacheStats();
+
+    Block first {"a b [c d]"};
+    Block second {"a b [c d]"};
+
+    auto after = runtime.scanCacheStats();
+    assert(after.misses == before.misses + 1);
+    assert(after.hits == before.hits + 1);
+
+    runtime("append", static_cast<Block>(second[3]), 10);
+    assert(static_cast<Block>(first[3]).length() == 2);
+    assert(static_cast<Block>(second[3]).length() == 3);
+
+    // Fragments that miss the cache are bound together in one pass, and
+    // words new to the context still pick up their values from lib
+
+    auto fragments = runtime.scanCacheStats();
+    Value sum = runtime("alpha: 1", "beta: 2", "add alpha beta");
+    assert(sum.isEqualTo(3));
+    assert(runtime.scanCacheStats().misses == fragments.misses + 3);
 }
@@ -0,0 +1,37 @@
+#include <iostream>
+#include <cassert>
+#include <string>
+
+#include "rencpp/ren.hpp"
+
+using namespace ren;
+
+int main(int, char **) {
+    // Pieces of one buffer, none of them followed by a NUL
+    std::string buffer = "[1 2 3]first[a b]10 + 20";
+    char const * data = buffer.data();
+
+    Block loaded {internal::Loadable {data, 7}};
+    assert(loaded.isEqualTo(Block {"[1 2 3]"}));
+
+    Value result = runtime(
+        internal::Loadable {data + 7, 5},
+        internal::Loadable {data + 12, 5}
+    );
+    assert(result.isEqualTo(Word {"a"}));
+
+    assert(runtime(internal::Loadable {data + 17, 7}).isEqualTo(30));
+
+    // A slice of the same bytes that's shorter must not see the rest
+    assert(runtime(internal::Loadable {data + 17, 2}).isEqualTo(10));
+
+    // UTF-16 slices (such as from a QString) are encoded by the hook
+    std::u16string wide = u"[1 2 3]first[\u0444 b]10 + 20";
+    char16_t const * units = wide.data();
+
+    assert(runtime(internal::Loadable {units + 17, 7}).isEqualTo(30));
+    assert(
+        runtime("first", internal::Loadable {units + 12, 5})
+            .isEqualTo(Word {"\u0444"})
+    );
+}
@@ -0,0 +1,54 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+
+#include "rencpp/ren.hpp"
+
+using namespace ren;
+
+int main(int, char **) {
+    // Text that fits in Latin-1 is kept a byte per character
+    String hello {"Hello World"};
+    auto view = hello.view();
+    assert(view.encoding() == String::View::Encoding::Latin1);
+    assert(view.size() == 11);
+    assert(std::memcmp(view.latin1(), "Hello World", 11) == 0);
+    assert(view[4] == 'o');
+
+    // The view starts at the string's position, not its head
+    String world = static_cast<String>(runtime("skip", hello, 6));
+    auto worldView = world.view();
+    assert(worldView.size() == 5);
+    assert(worldView[0] == 'W');
+    assert(worldView.data() == view.latin1() + 6);
+
+    // Anything wider is kept two bytes per character
+    String wide {"xфy"};
+    auto wideView = wide.view();
+    assert(wideView.encoding() == String::View::Encoding::Ucs2);
+    assert(wideView.size() == 3);
+    assert(wideView.ucs2()[1] == 0x444);
+    assert(wideView[0] == 'x');
+    assert(wideView[2] == 'y');
+
+    // The view keeps the string alive after the last Value for it is gone
+    auto orphan = String {"still here"}.view();
+    runtime("recycle");
+    assert(orphan.size() == 10);
+    assert(std::memcmp(orphan.latin1(), "still here", 10) == 0);
+
+    // Views and iterators made through a Ref hold their own reference, so
+    // they outlive the Value that was lent out too
+    Value lender {String {"lent out"}};
+    auto lentView = lender.as<String>()->view();
+    auto lentIt = lender.as<String>()->begin();
+    lender = Value {none};
+    runtime("recycle");
+    assert(lentView.size() == 8);
+    assert(std::memcmp(lentView.latin1(), "lent out", 8) == 0);
+    assert((*lentIt).isEqualTo(Character {'l'}));
+
+    // Empty, or at the tail
+    assert(String {""}.view().empty());
+    assert(static_cast<String>(runtime("tail", hello)).view().empty());
+}
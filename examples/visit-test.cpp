@@ -0,0 +1,73 @@
+#include <iostream>
+#include <cassert>
+
+#include "rencpp/ren.hpp"
+
+using namespace ren;
+
+int main(int, char **) {
+
+    Block stuff {"foo", "<bar>", 1020, 3.04, true, Block {}, "{baz}"};
+
+    assert(stuff[1].kind() == Kind::Word);
+    assert(stuff[2].kind() == Kind::Tag);
+    assert(stuff[3].kind() == Kind::Integer);
+    assert(stuff[4].kind() == Kind::Float);
+    assert(stuff[5].kind() == Kind::Logic);
+    assert(stuff[6].kind() == Kind::Block);
+    assert(stuff[7].kind() == Kind::String);
+
+    assert(stuff[1].isKindOf(typesets::AnyWord));
+    assert(stuff[2].isKindOf(typesets::Series));
+    assert(not stuff[3].isKindOf(typesets::Series));
+    assert(stuff[6].isAnyBlock() and stuff[6].isSeries());
+
+    std::cout << "SUCCESS: kinds and typesets!\n";
+
+    int integers = 0;
+    int series = 0;
+    int others = 0;
+
+    for (auto value : stuff) {
+        visit(value, overloaded(
+            [&](Integer const & i) {
+                assert(static_cast<int>(i) == 1020);
+                integers++;
+            },
+            [&](Series const &) {
+                series++;
+            },
+            [&](Value const &) {
+                others++;
+            }
+        ));
+    }
+
+    assert(integers == 1);
+    assert(series == 4);
+    assert(others == 2);
+
+    // A visitor may return a value, if the result type is given
+
+    bool isFoo = visit<bool>(stuff[1], overloaded(
+        [](AnyWord const & word) { return word.hasSpelling("foo"); },
+        [](Value const &) { return false; }
+    ));
+    assert(isFoo);
+
+    // What a visitor is given owns its series, so it can be kept after the
+    // value that was visited is gone
+
+    Value kept;
+    {
+        Block temporary {"a", "b", "c"};
+        visit(temporary, overloaded(
+            [&](Block const & block) { kept = block; },
+            [](Value const &) {}
+        ));
+    }
+    runtime("recycle");
+    assert(runtime("length?", kept).isEqualTo(3));
+
+    std::cout << "SUCCESS: visit dispatch!\n";
+}
@@ -0,0 +1,75 @@
+#ifndef RENCPP_ARRAY_HPP
+#define RENCPP_ARRAY_HPP
+
+//
+// array.hpp
+// This file is part of RenCpp
+// Copyright (C) 2015 HostileFork.com
+//
+// Licensed under the Boost License, Version 1.0 (the "License")
+//
+//      http://www.boost.org/LICENSE_1_0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.  See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// See http://rencpp.hostilefork.com for more information on this project
+//
+
+#include "values.hpp"
+
+namespace ren {
+
+
+///
+/// PACKED ARRAY OF VALUES
+///
+
+//
+// A std::vector<Value> pays for a reference count and GC root per series
+// element, and when it's handed to an apply each element gets copied into
+// a Loadable.  ValueArray instead keeps its cells packed end-to-end inside
+// a block that belongs to the runtime.  That block is the only thing that
+// needs a reference count or protection; anything put in the array is kept
+// alive by being in it.
+//
+// Since the cells are contiguous, the array can be passed straight through
+// to RenConstructOrApply as the loadables with a stride of one cell.  And
+// toBlock() is just another handle on the same block, with nothing copied.
+// Be aware that means later changes to the array are seen through it.
+//
+// The elements are read back as Values, so there's no way to get a
+// reference into the storage that might be invalidated when it grows.
+//
+
+class ValueArray {
+private:
+    Block block;
+
+public:
+    explicit ValueArray (size_t capacity = 0, Engine * engine = nullptr);
+
+    size_t size() const;
+
+    bool empty() const { return size() == 0; }
+
+    void push_back(Value const & value);
+
+    Value operator[](size_t index) const;
+
+    void set(size_t index, Value const & value);
+
+    void clear();
+
+    Block const & toBlock() const { return block; }
+
+    // For handing to the hooks; invalidated by push_back()
+    RenCell const * cells() const;
+};
+
+} // end namespace ren
+
+#endif
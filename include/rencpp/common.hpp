@@ -54,6 +54,10 @@
 
     #include <string>
 
+    #if __cplusplus >= 201703L
+        #include <string_view>
+    #endif
+
 #elif REN_CLASSLIB_STD != 0
 
     static_assert(false, "Invalid value for REN_CLASSLIB_STD, not 0 or 1.");
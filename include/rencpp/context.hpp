@@ -114,8 +114,8 @@ public:
 
 public:
     template <typename... Ts>
-    Value operator()(Ts... args) {
-        return Runtime::evaluate({args...}, this);
+    Value operator()(Ts &&... args) {
+        return Runtime::evaluate({std::forward<Ts>(args)...}, this);
     }
 };
 
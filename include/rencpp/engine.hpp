@@ -140,6 +140,12 @@ public:
     void close() {
         auto releaseMe = handle;
         handle = REN_ENGINE_HANDLE_INVALID;
+        if (internal::ReleaseQueue::flush(releaseMe) != REN_SUCCESS) {
+            throw std::runtime_error (
+                "Refcounting problem reported by the Ren binding hook"
+            );
+        }
+        internal::ReleaseQueue::forget(releaseMe);
         if (::RenFreeEngine(releaseMe) != 0) {
             throw std::runtime_error ("Failed to shut down red environment");
         }
@@ -147,17 +153,26 @@ public:
 
 
     virtual ~Engine() {
-        if (not REN_IS_ENGINE_HANDLE_INVALID(handle))
+        if (not REN_IS_ENGINE_HANDLE_INVALID(handle)) {
+            internal::ReleaseQueue::flush(handle);
+            internal::ReleaseQueue::forget(handle);
             ::RenFreeEngine(handle);
+        }
     }
 
 public:
     template <typename... Ts>
-    Value operator()(Ts... args) {
-        return runtime({args...}, this);
+    Value operator()(Ts &&... args) {
+        return Runtime::evaluate({std::forward<Ts>(args)...}, this);
     }
 };
 
+
+inline void Value::finishInitImmediate(Engine * engine) {
+    refcountPtr = nullptr;
+    origin = engine ? engine->getHandle() : REN_ENGINE_HANDLE_INVALID;
+}
+
 } // end namespace ren
 
 #endif
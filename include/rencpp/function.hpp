@@ -22,6 +22,7 @@
 #include <cassert>
 #include <functional>
 #include <stdexcept>
+#include <string>
 #include <tuple>
 #include <type_traits>
 #include <utility>
@@ -50,6 +51,19 @@ namespace ren {
 // ANY-FUNCTION! types and not bother with inventing a separate AnyFunction?
 //
 
+namespace internal {
+    // Function::call() takes values only, not source text to be loaded
+    template <typename... Ts>
+    struct are_all_values : std::true_type {};
+
+    template <typename T, typename... Ts>
+    struct are_all_values<T, Ts...> : std::integral_constant<bool,
+        not std::is_convertible<T, char const *>::value
+        and not std::is_same<typename std::decay<T>::type, std::string>::value
+        and are_all_values<Ts...>::value
+    > {};
+}
+
 class Function : public Value {
 protected:
     friend class Value;
@@ -72,6 +86,30 @@ private:
         Block const & spec,
         RenShimPointer const & shim
     );
+
+public:
+    //
+    // call() is like apply() for when every argument is already a value.
+    // As no text has to be loaded, the runtime can put the arguments
+    // directly into the function's frame without building an argument block
+    // first.  The count and types of the arguments are checked against the
+    // spec, so too many arguments or one of the wrong type is an
+    // evaluation_error.  Arguments are passed as-is and not evaluated, so a
+    // Word argument is received as that word (use apply() with source text
+    // to get a word's value looked up).
+    //
+
+    template <typename... Ts>
+    Value call(Ts &&... args) const {
+        static_assert(
+            internal::are_all_values<Ts...>::value,
+            "Function::call() takes values, use apply() to load source text"
+        );
+        std::initializer_list<internal::Loadable> loadables {
+            std::forward<Ts>(args)...
+        };
+        return applyCells_(loadables.begin(), loadables.size());
+    }
 };
 
 
@@ -167,6 +205,26 @@ private:
     static std::vector<TableEntry> table;
 
 
+    // Parameters declared as a Ref<T> borrow the cell on the stack, which
+    // the evaluator keeps alive for the duration of the call.  Anything else
+    // gets an owning value.
+
+    template <class T>
+    static T makeArg(RenCell const & cell, RenEngineHandle engine, T *) {
+        return Value::construct_<T>(cell, engine);
+    }
+
+    template <class T>
+    static Ref<T> makeArg(
+        RenCell const & cell, RenEngineHandle engine, Ref<T> *
+    ) {
+        return Ref<T> {cell, engine};
+    }
+
+    template <class T>
+    using ParamType = typename std::decay<T>::type;
+
+
     // Function used to create Ts... on the fly and apply a
     // given function to them
 
@@ -179,25 +237,23 @@ private:
     )
         -> decltype(
             fun(
-                Value::construct_<
-                    typename std::decay<
-                        typename utility::type_at<Indices, Ts...>::type
-                    >::type
-                >(
+                makeArg(
                     *REN_STACK_ARGUMENT(stack, Indices),
-                    engine
+                    engine,
+                    static_cast<ParamType<
+                        typename utility::type_at<Indices, Ts...>::type
+                    > *>(nullptr)
                 )...
             )
         )
     {
         return fun(
-            Value::construct_<
-                typename std::decay<
-                    typename utility::type_at<Indices, Ts...>::type
-                >::type
-            >(
+            makeArg(
                 *REN_STACK_ARGUMENT(stack, Indices),
-                engine
+                engine,
+                static_cast<ParamType<
+                    typename utility::type_at<Indices, Ts...>::type
+                > *>(nullptr)
             )...
         );
     }
@@ -356,6 +356,59 @@ RenResult RenConstructOrApply(
 );
 
 
+/*
+ * When every argument to a function is a cell already (no text to load),
+ * there's no need for ConstructOrApply to gather them into a block.  This
+ * puts the cells straight into the function's frame as its arguments.
+ * Unlike applying through RenConstructOrApply, the arguments are taken
+ * as-is and never evaluated, and passing more arguments than the function
+ * takes is an error.  Results and errors come back as they do from
+ * RenConstructOrApply.
+ */
+
+RenResult RenApplyCells(
+    RenEngineHandle engine,
+    RenCell const * applicand,
+    RenCell const * cells,
+    size_t numCells,
+    size_t sizeofCell,
+    RenCell * applyOut,
+    RenCell * errorOut
+);
+
+
+/*
+ * Many independent requests may be given to ConstructOrApply at once, which
+ * saves the hook from setting up its error handling (and anything else it
+ * needs to do on entry) for each one.  The fields of each request are the
+ * same as the parameters of RenConstructOrApply, and the result code of each
+ * is written into its result.  A request that fails doesn't stop the ones
+ * after it.
+ *
+ * The batch's own result is REN_SUCCESS if all requests were run, even if
+ * some failed.  If an evaluation is cancelled or exits, the batch stops and
+ * that is returned; the requests not run get REN_EVALUATION_CANCELLED.
+ */
+
+struct RenConstructOrApplyRequest {
+    RenCell const * applicand;
+    RenCell const * loadablesCell;
+    size_t numLoadables;
+    size_t sizeofLoadable;
+    RenCell * constructOutDatatypeIn;
+    RenCell * applyOut;
+    RenCell * errorOut;
+    RenResult result;
+};
+
+RenResult RenConstructOrApplyMany(
+    RenEngineHandle engine,
+    RenContextHandle context,
+    struct RenConstructOrApplyRequest * requests,
+    size_t numRequests
+);
+
+
 /*
  * Every cell that needs it has to be released by the reference counting.
  * There should be only one release per cell returned by RedConstructOrApply.
@@ -396,4 +449,59 @@ RenResult RenFormAsUtf8(
     size_t * numBytesOut
 );
 
+
+/*
+ * Asking for the size and then calling again with a big enough buffer means
+ * forming twice.  This forms once and hands the UTF-8 to a sink function,
+ * which can copy it wherever it likes (e.g. straight into a std::string).
+ * The sink may be called more than once, with consecutive pieces of the
+ * text.  If it returns anything but REN_SUCCESS, forming stops and that
+ * result is returned.
+ */
+
+typedef RenResult (* RenUtf8SinkPointer)(
+    void * state,
+    char const * data,
+    size_t numBytes
+);
+
+RenResult RenFormAsUtf8Sink(
+    RenEngineHandle engine,
+    RenCell const * cell,
+    RenUtf8SinkPointer sink,
+    void * state
+);
+
+
+/*
+ * Showing a prefix of a big value shouldn't cost forming all of it.  This
+ * is like RenFormAsUtf8Sink, but gives the sink at most maxBytes of UTF-8
+ * (never splitting a character) and stops forming once that many have been
+ * produced, as MOLD/PART does.  truncatedOut is set nonzero if the text
+ * that was given is not the whole of the form.
+ */
+
+RenResult RenFormAsUtf8Part(
+    RenEngineHandle engine,
+    RenCell const * cell,
+    size_t maxBytes,
+    RenUtf8SinkPointer sink,
+    void * state,
+    int * truncatedOut
+);
+
+
+/*
+ * Running totals of the time the runtime has spent in the phases of loading
+ * text: scanning it into values, and binding the words of those values into
+ * a context.  Taking the difference across an operation tells where its
+ * loading time went.  A runtime that doesn't measure this gives zeros.
+ */
+
+RenResult RenLoadPhaseTotals(
+    RenEngineHandle engine,
+    int64_t * scanNanosecondsOut,
+    int64_t * bindNanosecondsOut
+);
+
 #endif
@@ -0,0 +1,121 @@
+#ifndef RENCPP_LOADER_HPP
+#define RENCPP_LOADER_HPP
+
+//
+// loader.hpp
+// This file is part of RenCpp
+// Copyright (C) 2015 HostileFork.com
+//
+// Licensed under the Boost License, Version 1.0 (the "License")
+//
+//      http://www.boost.org/LICENSE_1_0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.  See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// See http://rencpp.hostilefork.com for more information on this project
+//
+
+#include <functional>
+#include <istream>
+#include <vector>
+
+#include "values.hpp"
+
+namespace ren {
+
+
+///
+/// INCREMENTAL LOADER
+///
+
+//
+// Loading a big data file in one go needs the whole text and everything it
+// loads to be in memory at once.  A Loader instead reads its input a chunk
+// at a time, and cuts the text it has read at the last line break that's
+// between top-level values.  Everything up to the cut is scanned into a
+// block, and the rest is kept to go in front of the next chunk:
+//
+//     std::ifstream in ("events.log");
+//     Loader loader {in};
+//
+//     Block chunk;
+//     while (loader.nextChunk(chunk)) {
+//         for (auto item : chunk)
+//             ...
+//     }
+//
+// Or the values can be taken one at a time with next(), which scans a new
+// chunk whenever the last one runs out.
+//
+// Cutting is done with a light pass over the text that tracks [] and ()
+// nesting, strings, and comments...it doesn't know every lexical corner
+// (such as a tag with a line break in it).  So files are expected to have
+// their top-level values separated by line breaks, as log-style data is.
+// Memory in use is bounded by the chunk size plus the size of the largest
+// top-level value, as a value longer than a chunk has to be read whole.
+//
+
+class Loader {
+public:
+    static size_t const defaultChunkSize = 256 * 1024;
+
+private:
+    std::function<size_t(char *, size_t)> reader;
+    Context * context;
+    size_t chunkSize;
+    bool exhausted;
+
+    // Text that's been read but not scanned yet
+    std::vector<char> buffer;
+
+    // The cutting pass picks up where it left off when more is read
+    enum class Mode { Normal, Quoted, Braced, Comment };
+    Mode mode;
+    size_t depth;
+    size_t braces;
+    size_t position;
+    size_t boundary;
+
+    // What next() is handing out values from
+    Block current;
+    Block::iterator currentPosition;
+    Block::iterator currentEnd;
+
+    bool fill();
+
+    void findBoundary();
+
+public:
+    explicit Loader (
+        std::istream & in,
+        Context * context = nullptr,
+        size_t chunkSize = defaultChunkSize
+    );
+
+#ifndef _WIN32
+    // Reads from a file descriptor, which is not closed by the Loader
+    explicit Loader (
+        int fd,
+        Context * context = nullptr,
+        size_t chunkSize = defaultChunkSize
+    );
+#endif
+
+    Loader (Loader const &) = delete;
+    Loader & operator= (Loader const &) = delete;
+
+    // Sets the block to the values in the next chunk of input, false if the
+    // input has all been loaded
+    bool nextChunk(Block & chunk);
+
+    // Sets the value to the next top-level value, false at end of input
+    bool next(Value & value);
+};
+
+} // end namespace ren
+
+#endif
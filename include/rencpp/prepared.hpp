@@ -0,0 +1,146 @@
+#ifndef RENCPP_PREPARED_HPP
+#define RENCPP_PREPARED_HPP
+
+//
+// prepared.hpp
+// This file is part of RenCpp
+// Copyright (C) 2015 HostileFork.com
+//
+// Licensed under the Boost License, Version 1.0 (the "License")
+//
+//      http://www.boost.org/LICENSE_1_0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.  See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// See http://rencpp.hostilefork.com for more information on this project
+//
+
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+#include "values.hpp"
+#include "array.hpp"
+
+namespace ren {
+
+
+///
+/// ARGUMENT SLOTS
+///
+
+//
+// These stand in for the arguments in the code given to a Prepared, in the
+// spirit of std::placeholders.  They are in their own namespace so that
+// `using namespace ren` doesn't make them collide with those.
+//
+
+struct Slot {
+    size_t number;
+};
+
+namespace placeholders {
+
+constexpr Slot _1 {1};
+constexpr Slot _2 {2};
+constexpr Slot _3 {3};
+constexpr Slot _4 {4};
+constexpr Slot _5 {5};
+constexpr Slot _6 {6};
+constexpr Slot _7 {7};
+constexpr Slot _8 {8};
+constexpr Slot _9 {9};
+
+} // end namespace placeholders
+
+
+namespace internal {
+
+class PreparedItem {
+private:
+    friend class ren::Prepared;
+
+    Loadable loadable;
+    size_t slot; // 0 if not a slot
+
+public:
+    PreparedItem (Slot const & slot) :
+        loadable (unset),
+        slot (slot.number)
+    {
+    }
+
+    template <
+        typename T,
+        typename = typename std::enable_if<
+            std::is_constructible<Loadable, T>::value
+        >::type
+    >
+    PreparedItem (T && loadable) :
+        loadable (std::forward<T>(loadable)),
+        slot (0)
+    {
+    }
+};
+
+} // end namespace internal
+
+
+
+///
+/// PREPARED EVALUATIONS
+///
+
+//
+// Code that is run over and over with different arguments, as in:
+//
+//     runtime("append", data, "reduce", item);
+//
+// pays each time for scanning and binding the text, as well as for a block
+// to gather everything into.  A Prepared does the scanning and binding once,
+// leaving slots in the code where the arguments go:
+//
+//     using namespace ren::placeholders;
+//     Prepared appender {"append", _1, "reduce", _2};
+//     appender(data, item);
+//
+// The code is kept in a ValueArray, and when it is run the arguments are
+// written straight into their slots and the cells handed to the evaluator
+// as they are.  Like any other values passed to runtime(...), the arguments
+// are spliced into the code and not quoted, so a word or function passed as
+// an argument will be evaluated.
+//
+// Running a Prepared changes its slots, so it should not be run from more
+// than one thread at a time.
+//
+
+class Prepared {
+private:
+    Context * context;
+    ValueArray code;
+    std::vector<std::pair<size_t, size_t>> slots; // (number, index in code)
+    size_t arity;
+
+    Value execute(std::initializer_list<Value> args);
+
+public:
+    Prepared (
+        std::initializer_list<internal::PreparedItem> items,
+        Context * context = nullptr
+    );
+
+    size_t getArity() const { return arity; }
+
+    template <typename... Ts>
+    Value operator()(Ts const &... args) {
+        return execute({Value (args)...});
+    }
+};
+
+} // end namespace ren
+
+#endif
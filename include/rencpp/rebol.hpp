@@ -21,14 +21,21 @@
 
 #include "runtime.hpp"
 
-#ifndef NDEBUG
-#include <unordered_map>
-#endif
-
 namespace ren {
 
 namespace internal {
     class RebolHooks;
+
+    // Set in the length kept in a text loadable's cell if the text has a
+    // NUL after it, so the hook can scan it without copying
+    REBCNT const loadableTerminated = 0x80000000;
+
+    // Set instead of a length if the loadable is a block to splice in
+    REBCNT const loadableSplice = 0x40000000;
+
+    // Set in the length if the text is UTF-16, with the length counting
+    // its code units rather than bytes
+    REBCNT const loadableUtf16 = 0x20000000;
 }
 
 // Not only is Runtime implemented on a per-binding basis
@@ -63,19 +70,32 @@ public:
 
     void cancel() override;
 
+    // Text that is loaded is scanned once and the bound result is kept in a
+    // bounded cache, which is copied from when the same text (in the same
+    // context) is loaded again.  These numbers say how well that's working.
+
+    struct ScanCacheStats {
+        size_t hits;
+        size_t misses;
+        size_t entries;
+    };
+
+    ScanCacheStats scanCacheStats() const;
+
     ~RebolRuntime() override;
 };
 
 extern RebolRuntime runtime;
 
-#ifndef NDEBUG
 namespace internal {
-    extern std::unordered_map<
-        decltype(RebolEngineHandle::data),
-        std::unordered_map<REBSER const *, unsigned int>
-    > nodes;
+    // Registers the series in a cell as a GC root for a C++ handle, giving
+    // back the index that RenReleaseCells needs to drop it again
+    size_t protectCell(RebolEngineHandle engine, REBVAL const & cell);
+
+    // Makes sure the runtime is started, and that the calling thread has
+    // been set up to use it, for code that calls Rebol without a hook
+    void enterRuntime(RebolEngineHandle engine);
 }
-#endif
 
 } // end namespace ren
 
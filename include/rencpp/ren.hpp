@@ -29,11 +29,15 @@
 //
 
 #include "values.hpp"
+#include "array.hpp"
 #include "exceptions.hpp"
 #include "function.hpp"
+#include "visit.hpp"
 #include "runtime.hpp"
 #include "engine.hpp"
 #include "context.hpp"
+#include "prepared.hpp"
+#include "loader.hpp"
 
 
 ///
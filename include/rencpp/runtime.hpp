@@ -19,7 +19,11 @@
 // See http://rencpp.hostilefork.com for more information on this project
 //
 
+#include <chrono>
 #include <initializer_list>
+#include <string>
+#include <utility> // std::forward
+#include <vector>
 
 #include "common.hpp"
 #include "values.hpp"
@@ -28,6 +32,53 @@
 namespace ren {
 
 
+///
+/// BATCH RESULTS
+///
+
+//
+// Each evaluation in a batch succeeds or fails on its own, so the errors
+// can't just be thrown.  A BatchResult holds one or the other, and get()
+// throws the evaluation_error if it failed.
+//
+
+class BatchResult {
+private:
+    friend class Runtime;
+
+    Value value;
+    Value errorValue;
+    bool failed;
+
+public:
+    BatchResult () : failed (false) {}
+
+    bool succeeded() const { return not failed; }
+
+    Value const & get() const;
+
+    Value const & error() const { return errorValue; }
+};
+
+
+
+///
+/// LOAD TIMINGS
+///
+
+//
+// Where the time went when loading a file: mapping it into memory, scanning
+// the text into values, and binding the words of those values to a context.
+//
+
+struct LoadTimings {
+    std::chrono::nanoseconds map;
+    std::chrono::nanoseconds scan;
+    std::chrono::nanoseconds bind;
+};
+
+
+
 ///
 /// BASE RUNTIME CLASS
 ///
@@ -84,14 +135,61 @@ public:
         return evaluate(loadables.begin(), loadables.size(), context);
     }
 
+    // Forwarding lets temporaries hand their references to the loadables
+    // instead of being copied; see notes on Loadable.
+
     template <typename... Ts>
-    static inline Value evaluate(Ts const &... args) {
-        return evaluate({args...}, static_cast<Context *>(nullptr));
+    static inline Value evaluate(Ts &&... args) {
+        return evaluate(
+            {std::forward<Ts>(args)...}, static_cast<Context *>(nullptr)
+        );
     }
 
+    // Many small evaluations that don't depend on each other can be run as
+    // one batch, which has the runtime set up for evaluating only once:
+    //
+    //     auto results = runtime.evaluateBatch({
+    //         {"first", data},
+    //         {"1 + 2"},
+    //         {"append", data, 10}
+    //     });
+    //
+    // The results are in the same order as the requests.  An error in one
+    // evaluation is kept in its result, and the batch carries on.  But if
+    // an evaluation is cancelled or asks to exit, the exception is thrown
+    // for the whole batch.
+
+    static std::vector<BatchResult> evaluateBatch(
+        std::initializer_list<
+            std::initializer_list<internal::Loadable>
+        > requests,
+        Context * context = nullptr
+    );
+
+    // Files are mapped into memory read-only and scanned from there, so a
+    // large data file isn't copied into a string (and measured) before it
+    // can be loaded.  loadFile gives back the bound block without running
+    // it, and evaluateFile runs it as DO would.  If timings are asked for,
+    // they're filled in for the call.  A file that can't be opened or read
+    // is a std::runtime_error.
+
+    static Block loadFile(
+        std::string const & path,
+        Context * context = nullptr,
+        LoadTimings * timings = nullptr
+    );
+
+    static Value evaluateFile(
+        std::string const & path,
+        Context * context = nullptr,
+        LoadTimings * timings = nullptr
+    );
+
     template <typename... Ts>
-    inline Value operator()(Ts const &... args) const {
-        return evaluate({args...}, static_cast<Context *>(nullptr));
+    inline Value operator()(Ts &&... args) const {
+        return evaluate(
+            {std::forward<Ts>(args)...}, static_cast<Context *>(nullptr)
+        );
     }
 
 
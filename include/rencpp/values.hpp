@@ -19,7 +19,10 @@
 // See http://rencpp.hostilefork.com for more information on this project
 //
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <functional>
 #include <initializer_list>
 #include <iosfwd>
 #include <stdexcept>
@@ -32,6 +35,25 @@
 
 #include "common.hpp"
 
+// See the REFERENCE COUNT POOL section for what this switches
+#ifndef REN_REFCOUNT_THREADSAFE
+
+    #define REN_REFCOUNT_THREADSAFE 1
+
+#elif REN_REFCOUNT_THREADSAFE == 0
+
+    #ifndef NDEBUG
+        #include <thread>
+    #endif
+
+#elif REN_REFCOUNT_THREADSAFE != 1
+
+    static_assert(
+        false, "Invalid value for REN_REFCOUNT_THREADSAFE, not 0 or 1."
+    );
+
+#endif
+
 
 extern "C" {
 #include "hooks.h"
@@ -71,6 +93,15 @@ class Context;
 
 class Engine;
 
+class ValueArray;
+
+class Prepared;
+
+class Runtime;
+
+template <class T>
+class Ref;
+
 
 namespace internal {
     //
@@ -93,6 +124,22 @@ namespace internal {
 
     template <class R, class... Ts>
     class FunctionGenerator;
+
+    // Forms the values that don't need the runtime's help to be formed
+    // (integers, floats, logic, none, and characters) straight into the
+    // buffer, which must have room for formImmediateMax bytes.  Returns
+    // false if the value has to be formed by the hooks instead.
+    size_t const formImmediateMax = 32;
+    bool formImmediate(RenCell const & cell, char * buffer, size_t & numBytes);
+
+    // Lets the variadic apply() step aside for a lone ValueArray argument
+    template <typename... Ts>
+    struct is_value_array : std::false_type {};
+
+    template <typename T>
+    struct is_value_array<T> : std::is_same<
+        typename std::decay<T>::type, ValueArray
+    > {};
 }
 
 
@@ -131,6 +178,9 @@ public:
 // you can call them explicitly as e.g. ren::to_string(...), if you do
 // `using std::to_string;` and then use the unqualified `to_string(...)`,
 // it will notice that the argument is a ren:: type and pick these versions
+//
+// Integers, floats, logic, none, and characters are formed in C++ without
+// calling into the runtime, giving the same text the runtime would.
 
 #if REN_CLASSLIB_STD
 std::string to_string (Value const & value);
@@ -140,6 +190,274 @@ std::string to_string (Value const & value);
 QString to_QString(Value const & value);
 #endif
 
+// The formed UTF-8 can also be streamed to a Sink, which is called with
+// consecutive pieces of it as they are encoded.  The whole text is never
+// gathered in one place, and the runtime forms a block an item at a time,
+// so the memory used is bounded by the biggest single item in the value
+// rather than by the whole.  format_to is the same for an output iterator:
+//
+//     std::vector<char> out;
+//     format_to(std::back_inserter(out), value);
+
+using Sink = std::function<void(char const * data, size_t numBytes)>;
+
+void formTo(Sink const & sink, Value const & value);
+
+// When only the start of a value is going to be shown (in a watch window,
+// or a log line) the form can be given a limit in bytes.  Forming stops
+// once the limit is reached, like MOLD/PART, so the cost is about that of
+// the part shown rather than of the whole value.  The text is cut between
+// characters, and *truncated (if given) says whether anything was left off:
+//
+//     bool truncated;
+//     std::string preview = to_string(hugeBlock, 80, &truncated);
+//     if (truncated)
+//         preview += "...";
+
+#if REN_CLASSLIB_STD
+std::string to_string (
+    Value const & value, size_t maxBytes, bool * truncated = nullptr
+);
+#endif
+
+#if REN_CLASSLIB_QT
+QString to_QString(
+    Value const & value, size_t maxBytes, bool * truncated = nullptr
+);
+#endif
+
+void formTo(
+    Sink const & sink,
+    Value const & value,
+    size_t maxBytes,
+    bool * truncated = nullptr
+);
+
+template <class OutputIt>
+OutputIt format_to(OutputIt out, Value const & value) {
+    formTo(
+        [&out](char const * data, size_t numBytes) {
+            out = std::copy(data, data + numBytes, out);
+        },
+        value
+    );
+    return out;
+}
+
+
+
+///
+/// REFERENCE COUNT POOL
+///
+
+//
+// Every series value that gets bridged into C++ needs a reference count that
+// is shared among its copies.  Going through the global `new` and `delete`
+// for each of these would put the allocator on the hot path of every call
+// that hands back a Block or String.  So the counts are carved out of slabs
+// and recycled through a free list; once the pool has grown to cover the
+// peak number of live series handles, no further allocations are made.
+//
+// The binding has no way to map an engine handle back to its Engine object
+// (see https://github.com/hostilefork/rencpp/issues/16) so there is a single
+// pool shared by all engines.  Slabs are never returned to the system.
+// Each thread keeps a free list of its own, and only takes the pool's lock
+// to move slots between that and the pool a batch at a time.
+//
+// By default the counts are atomic, so handles may be copied and dropped on
+// any thread.  The hooks themselves are not thread-safe, so an embedding
+// that only talks to the binding from one thread can build with
+// REN_REFCOUNT_THREADSAFE=0 to use plain integers and skip the pool's lock.
+// Debug builds then check that all the counting happens on one thread.
+//
+
+namespace internal {
+
+#if REN_REFCOUNT_THREADSAFE
+using RefcountType = std::atomic<unsigned int>;
+#else
+using RefcountType = unsigned int;
+#endif
+
+class RefcountPool {
+public:
+    // The count handed back is already initialized to 1
+    static RefcountType * allocate();
+
+    static void release(RefcountType * refcountPtr);
+
+    // Diagnostic for benchmarks and tests; growth should level off
+    static size_t slabsAllocated();
+
+    // Each count can carry an index the runtime binding uses to find the GC
+    // root it made for the handle, so it can be dropped in O(1) on release
+    static void setRootIndex(RefcountType * refcountPtr, size_t index);
+
+    static size_t rootIndex(RefcountType const * refcountPtr);
+
+#if (REN_REFCOUNT_THREADSAFE == 0) and !defined(NDEBUG)
+    static std::thread::id affinity;
+
+    static void checkAffinity() {
+        if (affinity == std::thread::id {})
+            affinity = std::this_thread::get_id();
+        assert(affinity == std::this_thread::get_id());
+    }
+#else
+    static void checkAffinity() {}
+#endif
+};
+
+} // end namespace internal
+
+
+
+///
+/// DEFERRED RELEASE QUEUE
+///
+
+//
+// When the last C++ handle on a series goes away, the runtime has to be told
+// so it can stop keeping the series alive.  Crossing into the hooks for each
+// handle that dies is wasteful when a loop is dropping them by the hundreds,
+// so the dying cells are parked in a buffer per engine.  They are handed to
+// RenReleaseCells in one batch when the buffer fills up, before each call
+// into the evaluator, and when the engine is shut down.
+//
+// Nothing can see a parked cell from C++ anymore; the only effect of the
+// delay is that the runtime's GC may hold onto the series a little longer.
+//
+
+namespace internal {
+
+// What RenReleaseCells is handed, with sizeof(ReleasedCell) as the stride.
+// The hooks.h contract allows data after each cell for the binding's use.
+
+struct ReleasedCell {
+    RenCell cell;
+    size_t rootIndex;
+};
+
+class ReleaseQueue {
+public:
+    // Takes the dead count back to the pool along with parking the cell.
+    // Safe on any thread, as it never calls the hooks, and never throws.
+    static void defer(
+        RenEngineHandle engine,
+        RenCell const & cell,
+        RefcountType * refcountPtr
+    ) noexcept;
+
+    // These call the hooks, so only threads that are calling into the
+    // runtime anyway may use them
+    static RenResult flush(RenEngineHandle engine);
+
+    static void flushIfFull(RenEngineHandle engine);
+
+    // Drops what's queued for an engine that has been freed
+    static void forget(RenEngineHandle engine);
+
+    // Diagnostics for benchmarks and tests.  lost() counts the cells that
+    // defer() couldn't queue, whose series were kept alive as a result.
+    static size_t pending(RenEngineHandle engine);
+
+    static size_t lost();
+};
+
+} // end namespace internal
+
+
+
+///
+/// DATATYPE KINDS
+///
+
+//
+// Rather than have generic code ask isInteger(), isBlock(), isString()...
+// in turn to find out what it's holding, Value::kind() says which of these
+// it is in one step.  The mapping from the runtime's type in the cell header
+// is a dense switch, which compiles to a table lookup.
+//
+// Each kind has a bit in a Typeset, so a question like "is this any kind of
+// word?" is a single AND of the value's bit against a mask.  The isAnyXxx()
+// predicates (and so the checks in the casting operators) are done this way.
+//
+// Types the binding doesn't have a use for yet are lumped in as Other.
+//
+
+enum class Kind : unsigned char {
+    Other,
+    Unset,
+    None,
+    Logic,
+    Character,
+    Integer,
+    Float,
+    Date,
+    Time,
+    Word,
+    SetWord,
+    GetWord,
+    LitWord,
+    Refinement,
+    Issue,
+    Block,
+    Paren,
+    Path,
+    SetPath,
+    GetPath,
+    LitPath,
+    String,
+    Tag,
+    File,
+    Url,
+    Function,
+    Native,
+    Closure,
+    Action,
+    Error,
+
+    Max // not a kind; the number of them
+};
+
+using Typeset = std::uint32_t;
+
+static_assert(
+    static_cast<unsigned>(Kind::Max) <= sizeof(Typeset) * 8,
+    "Too many kinds to fit a bit for each in a Typeset"
+);
+
+constexpr Typeset typesetOf(Kind kind) {
+    return Typeset {1} << static_cast<unsigned>(kind);
+}
+
+namespace typesets {
+
+constexpr Typeset AnyWord =
+    typesetOf(Kind::Word) | typesetOf(Kind::SetWord)
+    | typesetOf(Kind::GetWord) | typesetOf(Kind::LitWord)
+    | typesetOf(Kind::Refinement) | typesetOf(Kind::Issue);
+
+constexpr Typeset AnyBlock =
+    typesetOf(Kind::Block) | typesetOf(Kind::Paren)
+    | typesetOf(Kind::Path) | typesetOf(Kind::SetPath)
+    | typesetOf(Kind::GetPath) | typesetOf(Kind::LitPath);
+
+constexpr Typeset AnyString =
+    typesetOf(Kind::String) | typesetOf(Kind::Tag)
+    | typesetOf(Kind::File) | typesetOf(Kind::Url);
+
+constexpr Typeset Series = AnyBlock | AnyString;
+
+// Really, from a user's point of view...shouldn't there only be
+// ANY_FUNCTION?  So isFunction() is true for all of these.
+
+constexpr Typeset AnyFunction =
+    typesetOf(Kind::Function) | typesetOf(Kind::Native)
+    | typesetOf(Kind::Closure) | typesetOf(Kind::Action);
+
+} // end namespace typesets
+
 
 
 ///
@@ -166,6 +484,12 @@ class Value {
 protected:
     friend class Function; // needs to extract series from spec block
     friend class ren::internal::Series_; // iterator state
+    friend class ren::internal::Loadable; // borrows cells without a ref
+    friend class ValueArray; // cells live in a block it holds
+    friend class AnyBlock; // hands the cells of a Value array to the hook
+    friend class Prepared; // evaluates the cells of a ValueArray
+    template <class T>
+    friend class Ref; // holds a cell without a ref
 
     RenCell cell;
 
@@ -184,11 +508,11 @@ protected:
     // to ren::Values into a ren::Series.
     //
     // Reference counts aren't copy constructible (by design), which means
-    // hat when a series value gets wrapped we do a `new` on the atomic.  On
-    // the plus side: copying that value around won't make any more of them,
-    // and non-series values don't have them at all.
+    // that when a series value gets wrapped we take a slot for the atomic
+    // from the RefcountPool.  On the plus side: copying that value around
+    // won't make any more of them, and non-series values don't have them.
     //
-    using RefcountType = std::atomic<unsigned int>;
+    using RefcountType = internal::RefcountType;
     RefcountType * refcountPtr;
 
     //
@@ -245,6 +569,15 @@ protected:
     void finishInit(RenEngineHandle engine);
     void finishInit(Engine * engine = nullptr);
 
+    // Immediates (integers, logic, characters...) need neither a reference
+    // count nor an engine.  So constructing them doesn't consult the finder,
+    // and they are left with an invalid origin unless one was given.  The
+    // engine is picked when they actually get handed to a hook; see
+    // hookEngine().  Defined in engine.hpp, where Engine is complete.
+    inline void finishInitImmediate(Engine * engine);
+
+    RenEngineHandle hookEngine() const;
+
     template<
         class T,
         typename = typename std::enable_if<
@@ -292,6 +625,22 @@ protected:
         return result;
     }
 
+    // Like construct_, but doesn't take out a reference count or GC root.
+    // Only for use by Ref, where something else guarantees the lifetime.
+
+    template<
+        class T,
+        typename = typename std::enable_if<
+            std::is_base_of<Value, T>::value
+        >::type
+    >
+    static T borrow_(RenCell const & cell, RenEngineHandle engine) {
+        T result {Dont::Initialize};
+        result.cell = cell;
+        result.origin = engine;
+        return result;
+    }
+
 
     //
     // At first the only user-facing constructor that was exposed directly
@@ -456,24 +805,37 @@ public:
 
     bool isError() const;
 
+public:
+    Kind kind() const;
+
+    bool isKindOf(Typeset typeset) const {
+        return (typesetOf(kind()) & typeset) != 0;
+    }
+
 protected:
     bool needsRefcount() const;
 
+    // A Ref's value has the bits of a series but no reference count (see
+    // borrow_).  Anything copied from it has to take a reference of its own,
+    // or an iterator or view made through the Ref would quietly outlive the
+    // series with nothing keeping it alive.
+    bool isBorrowed() const {
+        return not refcountPtr
+            and not REN_IS_ENGINE_HANDLE_INVALID(origin)
+            and needsRefcount();
+    }
+
 private:
-    inline void releaseRefIfNecessary() {
+    inline void releaseRefIfNecessary() noexcept {
         // refcount is nullptr if it's not an refcountable type, or if it was
         // a refcountable type and we used the move constructor to empty i
-        if (refcountPtr && !--(*refcountPtr)) {
-            delete refcountPtr;
-            if (
-                ::RenReleaseCells(origin, &this->cell, 1, sizeof(Value))
-                != REN_SUCCESS
-            ) {
-                throw std::runtime_error(
-                    "Refcounting problem reported by the Ren binding hook"
-                );
-            }
-        }
+        if (not refcountPtr)
+            return;
+
+        internal::RefcountPool::checkAffinity();
+
+        if (!--(*refcountPtr))
+            internal::ReleaseQueue::defer(origin, cell, refcountPtr);
     }
 
 public:
@@ -484,15 +846,24 @@ public:
     // Wondering what might happen if while you are initializing, another
     // thread decrements the refcount and it goes to zero before you can
     // finish?  Don't worry - you know at least one reference on this thread
-    // will be keeping it alive (the one that you are copying!)
+    // will be keeping it alive (the one that you are copying!)  That only
+    // holds with atomic counts; see REN_REFCOUNT_THREADSAFE.
+    //
+    // A copy of a borrowed value gets a count and GC root of its own, which
+    // is what makes the copies Series::begin() or AnyString::view() keep of
+    // *this safe to hold onto when they are called through a Ref.
     //
     Value (Value const & other) :
         cell (other.cell),
         refcountPtr (other.refcountPtr),
         origin (other.origin)
     {
-        if (refcountPtr)
+        if (refcountPtr) {
+            internal::RefcountPool::checkAffinity();
             (*refcountPtr)++;
+        }
+        else if (isBorrowed())
+            finishInit(origin);
     }
 
     //
@@ -501,9 +872,11 @@ public:
     //
     // User-defined move constructors should not throw exceptions.  We
     // trust the C++ type system here.  You can move a String into an
-    // AnySeries but not vice-versa.
+    // AnySeries but not vice-versa.  Being noexcept also means containers
+    // like std::vector<Block> will move their elements when they grow,
+    // instead of copying them and bumping every count.
     //
-    Value (Value && other) :
+    Value (Value && other) noexcept :
         cell (other.cell),
         refcountPtr (other.refcountPtr),
         origin (other.origin)
@@ -518,15 +891,42 @@ public:
     }
 
     Value & operator=(Value const & other) {
-        // we're about to overwrite the content, so release the reference
-        // on the content we had
+        if (other.isBorrowed())
+            return *this = Value {other};
+
+        // Take our reference on the new content before we drop the one on
+        // the old, in case they are the same series (e.g. x = x) and ours
+        // was the last reference to it.
+        if (other.refcountPtr) {
+            internal::RefcountPool::checkAffinity();
+            (*other.refcountPtr)++;
+        }
+
         releaseRefIfNecessary();
 
         cell = other.cell;
         refcountPtr = other.refcountPtr;
-        if (refcountPtr) {
-            (*refcountPtr)++;
-        }
+        origin = other.origin;
+        return *this;
+    }
+
+    //
+    // Move assignment releases what we had and takes over the other's
+    // reference.  Like the destructor it can't throw, as releasing only
+    // queues the cell (see ReleaseQueue::defer).
+    //
+    Value & operator=(Value && other) noexcept {
+        if (this == &other)
+            return *this;
+
+        releaseRefIfNecessary();
+
+        cell = other.cell;
+        refcountPtr = other.refcountPtr;
+        origin = other.origin;
+
+        other.refcountPtr = nullptr;
+        other.origin = REN_ENGINE_HANDLE_INVALID;
         return *this;
     }
 
@@ -545,6 +945,29 @@ public:
     friend QString to_QString(Value const & value);
 #endif
 
+    friend std::ostream & operator<<(std::ostream & os, Value const & value);
+
+    friend void formTo(Sink const & sink, Value const & value);
+
+#if REN_CLASSLIB_STD
+    friend std::string to_string (
+        Value const & value, size_t maxBytes, bool * truncated
+    );
+#endif
+
+#if REN_CLASSLIB_QT
+    friend QString to_QString(
+        Value const & value, size_t maxBytes, bool * truncated
+    );
+#endif
+
+    friend void formTo(
+        Sink const & sink,
+        Value const & value,
+        size_t maxBytes,
+        bool * truncated
+    );
+
 
     //
     // Equality and Inequality
@@ -606,9 +1029,18 @@ public:
         Context * context = nullptr
     ) const;
 
-    template <typename... Ts>
-    inline Value apply(Ts const &... args) const {
-        return apply({ args... });
+    // Passes the array's cells straight through as the arguments, with no
+    // Loadable made for each one.  Defined in array.cpp.
+    Value apply(ValueArray const & args, Context * context = nullptr) const;
+
+    template <
+        typename... Ts,
+        typename = typename std::enable_if<
+            not internal::is_value_array<Ts...>::value
+        >::type
+    >
+    inline Value apply(Ts &&... args) const {
+        return apply({ std::forward<Ts>(args)... });
     }
 
     template <typename... Ts>
@@ -635,7 +1067,7 @@ public:
             and not std::is_same<Value, T>::value
         >::type
     >
-    explicit operator T () const
+    explicit operator T () const &
     {
         // Here's the tough bit.  How do we throw exceptions on all the right
         // cases?  Each class needs a checker for the bits.  So it constructs
@@ -654,6 +1086,81 @@ public:
         return result;
     }
 
+    // Casting a temporary (as in `static_cast<Block>(runtime(...))`) can
+    // hand its reference over instead of taking out a new one.  If the cast
+    // throws, the temporary still owns it and releases it as usual.
+
+    template <
+        class T,
+        typename = typename std::enable_if<
+            std::is_base_of<Value, T>::value
+            and not std::is_same<Value, T>::value
+        >::type
+    >
+    explicit operator T () &&
+    {
+        T result (Dont::Initialize);
+        result.cell = cell;
+
+        if (not result.isValid())
+            throw bad_value_cast("Invalid cast");
+
+        result.refcountPtr = refcountPtr;
+        result.origin = origin;
+
+        refcountPtr = nullptr;
+        origin = REN_ENGINE_HANDLE_INVALID;
+        return result;
+    }
+
+    // The cast operators make a new object, which means a refcount bump for
+    // series (and the finishInit work that goes with it).  Code that just
+    // wants to look at a value as a more specific type can instead get a
+    // Ref<T> to it: a T made from the same cell that takes no reference of
+    // its own (see BORROWED REFERENCES).
+    //
+    // as<T>() throws like the casts if you're wrong.  unchecked<T>() is for
+    // when you've already tested, e.g. by switching on kind(); it will only
+    // check in debug builds.  Either Ref is only good for as long as the
+    // value it came from, so they can't be taken from temporaries.
+
+    template <
+        class T,
+        typename = typename std::enable_if<
+            std::is_base_of<Value, T>::value
+            and not std::is_same<Value, T>::value
+        >::type
+    >
+    Ref<T> as() const &
+    {
+        Ref<T> result {cell, origin};
+
+        if (not result.value.isValid())
+            throw bad_value_cast("Invalid cast");
+
+        return result;
+    }
+
+    template <
+        class T,
+        typename = typename std::enable_if<
+            std::is_base_of<Value, T>::value
+            and not std::is_same<Value, T>::value
+        >::type
+    >
+    Ref<T> unchecked() const &
+    {
+        Ref<T> result {cell, origin};
+        assert(result.value.isValid());
+        return result;
+    }
+
+    template <class T, typename = void>
+    Ref<T> as() const && = delete;
+
+    template <class T, typename = void>
+    Ref<T> unchecked() const && = delete;
+
 
 public:
     // This can probably be done more efficiently, but the idea of wanting
@@ -699,12 +1206,114 @@ protected:
         Value * constructOutTypeIn,
         Value * applyOut
     );
+
+    // Loadables can be any strided array of cells, such as a ValueArray
+    static void constructOrApplyInitialize(
+        RenEngineHandle engine,
+        RenContextHandle context,
+        Value const * applicand,
+        RenCell const * loadablesCells,
+        size_t numLoadables,
+        size_t sizeofLoadable,
+        Value * constructOutTypeIn,
+        Value * applyOut
+    );
+
+    // Applies this function to arguments that are all values, with nothing
+    // to load and no argument block made; see RenApplyCells.  This is what
+    // Function::call() uses.
+    Value applyCells_(
+        internal::Loadable const loadables[],
+        size_t numLoadables
+    ) const;
+
+private:
+    // Turns a failed result from the hooks into the matching exception
+    static void throwHookError(
+        RenResult result,
+        RenEngineHandle engine,
+        Value & errorOut,
+        char const * hookName
+    );
 };
 
 std::ostream & operator<<(std::ostream & os, Value const & value);
 
 
 
+///
+/// BORROWED REFERENCES
+///
+
+//
+// Some values are known to stay alive for longer than the C++ code looking
+// at them: arguments sitting on the evaluator's stack while an extension
+// function runs, or the elements of a series being iterated (the iterator
+// holds the series).  Making an owning Value for each of these takes out
+// a reference count and GC root only to drop them again moments later.
+//
+// A Ref<T> holds the bits of a T without owning anything.  The T's methods
+// are reached through ->, and it converts to an owning T when you need one
+// to outlive the callback or the iteration:
+//
+//     Function first = makeFunction(
+//         "blk [block!]",
+//         REN_STD_FUNCTION,
+//         [](BlockRef blk) -> Value {
+//             return blk->isEmpty() ? Value {none} : *blk->begin();
+//         }
+//     );
+//
+// There is no operator* handing back a T reference, so a borrowed T can't
+// be copied out by accident.  Methods reached through -> that keep a copy
+// of the series (begin(), end(), view()) get an owning one, as copying a
+// borrowed value takes a reference.  For the same reason, hoist end() out
+// of a loop condition rather than paying for it on every element.  Don't
+// keep a Ref itself around past the point where the original is alive.
+//
+
+template <class T>
+class Ref {
+    static_assert(
+        std::is_base_of<Value, T>::value, "Ref can only borrow Value types"
+    );
+
+private:
+    template <class R, class... Ts>
+    friend class internal::FunctionGenerator;
+    friend class internal::Series_;
+    friend class internal::Loadable;
+    friend class Value; // as<T>() and unchecked<T>()
+
+    T value;
+
+    Ref (RenCell const & cell, RenEngineHandle engine) :
+        value (Value::borrow_<T>(cell, engine))
+    {
+    }
+
+public:
+    // Copying a Ref borrows again, instead of promoting like a T copy would
+    Ref (Ref const & other) :
+        value (Value::borrow_<T>(other.value.cell, other.value.origin))
+    {
+    }
+
+    Ref & operator=(Ref const & other) {
+        value = Value::borrow_<T>(other.value.cell, other.value.origin);
+        return *this;
+    }
+
+    T const * operator->() const { return &value; }
+
+    // Promote to an owning value, with its own reference
+    operator T () const {
+        return Value::construct_<T>(value.cell, value.origin);
+    }
+};
+
+
+
 ///
 /// NONE AND UNSET CONSTRUCTION
 ///
@@ -941,6 +1550,10 @@ public:
     Value operator*() const;
     Value operator->() const; // see notes on Value::operator->
 
+    // Same as operator* without making an owning Value; the series being
+    // enumerated keeps the element alive
+    Ref<Value> ref() const;
+
     void head();
     void tail();
 };
@@ -1081,6 +1694,9 @@ public:
 
         Value operator * () const { return *state; }
         Value operator-> () const { return state.operator->(); }
+
+        // Borrowed element, valid while the series is; see Ref
+        Ref<Value> ref() const { return state.ref(); }
     };
 
     iterator begin() const {
@@ -1236,6 +1852,81 @@ public:
     bool hasSpelling(char const * spelling) const {
         return spellingOf_STD() == spelling;
     }
+
+
+public:
+    //
+    // Reading a string by forming it to UTF-8 or by iterating Characters
+    // costs an allocation or a Value per character.  A View instead points
+    // at the characters from the string's position to its tail, right where
+    // the runtime keeps them.  That storage is either one byte per character
+    // (Latin-1) or two (UCS-2), as the encoding says:
+    //
+    //     auto view = someString.view();
+    //     size_t spaces = 0;
+    //     for (size_t i = 0; i < view.size(); i++)
+    //         if (view[i] == ' ')
+    //             spaces++;
+    //
+    // The View holds a reference to the string, so the data isn't garbage
+    // collected out from under it.  But it points into the series, so it
+    // goes stale if the string is modified while the View is in use.
+    //
+
+    class View {
+    public:
+        enum class Encoding { Latin1, Ucs2 };
+
+    private:
+        friend class AnyString;
+        Series owner;
+        void const * units;
+        size_t numUnits;
+        Encoding encodingValue;
+
+        View (
+            Series const & owner,
+            void const * units,
+            size_t numUnits,
+            Encoding encoding
+        ) :
+            owner (owner),
+            units (units),
+            numUnits (numUnits),
+            encodingValue (encoding)
+        {
+        }
+
+    public:
+        Encoding encoding() const { return encodingValue; }
+
+        // Number of code units, which is also the number of characters
+        size_t size() const { return numUnits; }
+
+        bool empty() const { return numUnits == 0; }
+
+        void const * data() const { return units; }
+
+        unsigned char const * latin1() const {
+            assert(encodingValue == Encoding::Latin1);
+            return static_cast<unsigned char const *>(units);
+        }
+
+        char16_t const * ucs2() const {
+            assert(encodingValue == Encoding::Ucs2);
+            return static_cast<char16_t const *>(units);
+        }
+
+        // Codepoint of the character at a 0-based index, either encoding
+        long operator[](size_t index) const {
+            assert(index < numUnits);
+            return encodingValue == Encoding::Latin1
+                ? static_cast<long>(latin1()[index])
+                : static_cast<long>(ucs2()[index]);
+        }
+    };
+
+    View view() const;
 };
 
 
@@ -1387,10 +2078,19 @@ public:
 // While private inheritance is one of those "frowned upon" institutions,
 // here we really do want it.  It's a perfect fit for the problem.
 //
+// Loadables only live as long as the full-expression they are written in
+// (the initializer_list of a call or block constructor), and all that gets
+// handed to the hook is the cell.  So a Loadable made from a Value the
+// caller is holding just borrows the bits and doesn't touch the refcount.
+// One made from a temporary takes over the temporary's reference, which
+// gets dropped when the call is done.  Either way, nothing is allocated.
+// Don't store Loadables anywhere that outlives the call.
+//
 
 class Loadable : private Value {
 private:
     friend class Value;
+    friend class ren::Runtime; // passes the cells of batches to the hook
 
     // These constructors *must* be public, although we really don't want
     // users of the binding instantiating loadables explicitly.
@@ -1399,26 +2099,234 @@ public:
 
     // Constructor inheritance does not inherit move or copy constructors
 
-    Loadable (Value const & value) : Value (value) {}
+    Loadable (Value const & value) : Value (Dont::Initialize) {
+        cell = value.cell;
+        origin = value.origin;
+    }
 
-    Loadable (Value && value) : Value (value) {}
+    // A copy lives no longer than the original, so it borrows too (the
+    // Value copy constructor would take a reference for a borrowed cell)
+
+    Loadable (Loadable const & other) : Value (Dont::Initialize) {
+        cell = other.cell;
+        origin = other.origin;
+    }
+
+    Loadable (Loadable && other) = default;
+
+    Loadable (Value && value) : Value (std::move(value)) {}
+
+    template <class T>
+    Loadable (Ref<T> const & ref) : Value (Dont::Initialize) {
+        cell = ref.value.cell;
+        origin = ref.value.origin;
+    }
 
     Loadable (char const * source);
 
+    // Text with a known length is handed over without being measured, and
+    // needn't be followed by a NUL...so a slice of a larger buffer can be
+    // loaded where it is.  The scanner does need a terminator, so unless
+    // `terminated` says there is one after the bytes, the hook copies them
+    // into a buffer of its own (which is reused, not allocated each time).
+
+    Loadable (char const * source, size_t length, bool terminated = false);
+
+    // UTF-16 text is handed over the same way, and the hook encodes it to
+    // UTF-8 for the scanner in that same reused buffer.  So a slice of a
+    // QString can be loaded without making a QByteArray for it.
+
+    Loadable (char16_t const * source, size_t length);
+
 #if REN_CLASSLIB_STD == 1
     Loadable (std::string const & source) :
-        Loadable (source.c_str())
+        Loadable (source.data(), source.size(), true)
     {
     }
 #endif
 
 #if REN_CLASSLIB_QT == 1
-    // TBD
+    Loadable (QByteArray const & source) :
+        Loadable (source.constData(), static_cast<size_t>(source.size()), true)
+    {
+    }
+
+    Loadable (QStringRef const & source) :
+        Loadable (
+            reinterpret_cast<char16_t const *>(source.unicode()),
+            static_cast<size_t>(source.size())
+        )
+    {
+    }
 #endif
+
+    // The contents of an already loaded block, to go into the code where
+    // the loadable is as if they had been written there.  See REN().
+
+    struct Splice {};
+
+    Loadable (Splice const &, AnyBlock const & block);
 };
 
 
 
+///
+/// SOURCE LITERALS CHECKED AT COMPILE TIME
+///
+
+//
+// Source fragments that are string literals get scanned (or found in the
+// scan cache) each time they're passed.  REN() instead scans its fragment
+// into a block once, the first time the expression runs, and then splices
+// that block's contents in wherever it's used:
+//
+//     runtime(REN("either all [x y] [print x]"), "[print y]");
+//
+// It also checks at compile time that the [] and () are balanced and
+// properly nested and that strings, {} strings, and comments are closed.
+// It does not catch every scan error (e.g. a malformed number).
+//
+// The block is bound in whatever context is current on first use.  As
+// with a literal block in Rebol source, series in it are shared by every
+// evaluation, so code that modifies its own literals will see those
+// changes the next time around.
+//
+// A user-defined literal like "print x"_ren can't be checked at compile
+// time in C++11 (its string parameter isn't a constant expression), hence
+// the macro.  A C++11 constexpr function can't loop, so the check recurses
+// instead.  It halves the text at each level rather than taking it a
+// character at a time, so the recursion is only as deep as the log of the
+// length and long fragments don't run into the compiler's depth limit.
+//
+// The static block lives until exit, and may be destroyed after the engine
+// is.  Its release is then only queued, and never handed to the runtime
+// (see ReleaseQueue).
+//
+
+// `stack` holds one bit per open [ (0) or ( (1), `mode` is '"' in a
+// string, ';' in a comment, and ' ' otherwise.  `escaped` is set after a ^
+// in a string or {} string, so the character after it is skipped.
+
+struct SourceState {
+    unsigned long long stack;
+    unsigned depth;
+    unsigned braces;
+    char mode;
+    bool escaped;
+    bool failed;
+};
+
+constexpr SourceState sourceFailed() {
+    return SourceState {0, 0, 0, ' ', false, true};
+}
+
+constexpr SourceState sourceStep(SourceState s, char c) {
+    return s.failed
+        ? s
+
+    : s.escaped
+        ? SourceState {s.stack, s.depth, s.braces, s.mode, false, false}
+
+    : s.mode == ';'
+        ? SourceState {
+            s.stack, s.depth, s.braces, c == '\n' ? ' ' : ';', false, false
+        }
+
+    : s.mode == '"'
+        ? (c == '^'
+            ? SourceState {s.stack, s.depth, s.braces, '"', true, false}
+            : c == '\n'
+                ? sourceFailed()
+                : SourceState {
+                    s.stack, s.depth, s.braces, c == '"' ? ' ' : '"',
+                    false, false
+                })
+
+    : s.braces != 0
+        ? (c == '^'
+            ? SourceState {s.stack, s.depth, s.braces, s.mode, true, false}
+            : SourceState {
+                s.stack,
+                s.depth,
+                c == '{' ? s.braces + 1 : c == '}' ? s.braces - 1 : s.braces,
+                s.mode,
+                false,
+                false
+            })
+
+    : c == ';' or c == '"'
+        ? SourceState {s.stack, s.depth, s.braces, c, false, false}
+
+    : c == '{'
+        ? SourceState {s.stack, s.depth, 1, s.mode, false, false}
+
+    : c == '[' or c == '('
+        ? (s.depth < 64
+            ? SourceState {
+                s.stack * 2 + (c == '(' ? 1 : 0), s.depth + 1, s.braces,
+                s.mode, false, false
+            }
+            : sourceFailed())
+
+    : c == ']' or c == ')'
+        ? (s.depth != 0 and s.stack % 2 == (c == ')' ? 1u : 0u)
+            ? SourceState {
+                s.stack / 2, s.depth - 1, s.braces, s.mode, false, false
+            }
+            : sourceFailed())
+
+    : c == '}'
+        ? sourceFailed()
+
+    : s;
+}
+
+constexpr SourceState sourceRun(
+    char const * text, size_t length, SourceState s
+) {
+    return length == 0
+        ? s
+        : length == 1
+            ? sourceStep(s, *text)
+            : sourceRun(
+                text + length / 2,
+                length - length / 2,
+                sourceRun(text, length / 2, s)
+            );
+}
+
+constexpr bool isBalancedEnd(SourceState s) {
+    return not s.failed and not s.escaped
+        and s.depth == 0 and s.braces == 0 and s.mode != '"';
+}
+
+template <size_t N>
+constexpr bool isBalancedSource(char const (&text)[N]) {
+    return isBalancedEnd(
+        sourceRun(text, N - 1, SourceState {0, 0, 0, ' ', false, false})
+    );
+}
+
+
+
+
+// Each use of the macro is its own lambda, so gets its own static block.
+// Initialization of that is thread-safe in C++11.
+
+#define REN(source) \
+    ([]() -> ren::internal::Loadable { \
+        static_assert( \
+            ren::internal::isBalancedSource(source), \
+            "REN() source has unbalanced brackets or an unclosed string" \
+        ); \
+        static ren::Block const block {source}; \
+        return ren::internal::Loadable { \
+            ren::internal::Loadable::Splice {}, block \
+        }; \
+    }())
+
+
+
 //
 // AnyBlock Subtype Helper
 //
@@ -1584,6 +2492,22 @@ public:
 };
 
 
+
+
+//
+// Shorthands for the borrowed views that come up the most; any other
+// value class can be used as Ref<T>
+//
+
+using ValueRef = Ref<Value>;
+
+using BlockRef = Ref<Block>;
+
+using StringRef = Ref<String>;
+
+using WordRef = Ref<Word>;
+
+
 } // end namespace ren
 
 #endif
@@ -0,0 +1,179 @@
+#ifndef RENCPP_VISIT_HPP
+#define RENCPP_VISIT_HPP
+
+//
+// visit.hpp
+// This file is part of RenCpp
+// Copyright (C) 2015 HostileFork.com
+//
+// Licensed under the Boost License, Version 1.0 (the "License")
+//
+//      http://www.boost.org/LICENSE_1_0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.  See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// See http://rencpp.hostilefork.com for more information on this project
+//
+
+#include <type_traits>
+#include <utility>
+
+#include "values.hpp"
+#include "function.hpp"
+
+namespace ren {
+
+
+///
+/// OVERLOAD SETS
+///
+
+//
+// This is the usual trick for making one function object out of several
+// lambdas, so that a visitor can be written inline:
+//
+//     ren::visit(value, ren::overloaded(
+//         [](Integer const & i) { ... },
+//         [](AnyBlock const & b) { ... },
+//         [](Value const & v) { ... }
+//     ));
+//
+// C++11 can't deduce class template arguments from a constructor, so it is
+// spelled as a function returning the combined object.
+//
+
+namespace internal {
+
+template <typename... Fs>
+struct Overloaded;
+
+template <typename F>
+struct Overloaded<F> : F {
+    template <typename G>
+    Overloaded (G && g) : F (std::forward<G>(g)) {}
+
+    using F::operator();
+};
+
+template <typename F, typename... Fs>
+struct Overloaded<F, Fs...> : F, Overloaded<Fs...> {
+    template <typename G, typename... Gs>
+    Overloaded (G && g, Gs &&... gs) :
+        F (std::forward<G>(g)),
+        Overloaded<Fs...> (std::forward<Gs>(gs)...)
+    {
+    }
+
+    using F::operator();
+    using Overloaded<Fs...>::operator();
+};
+
+} // end namespace internal
+
+
+template <typename... Fs>
+internal::Overloaded<typename std::decay<Fs>::type...> overloaded(
+    Fs &&... fs
+) {
+    return internal::Overloaded<typename std::decay<Fs>::type...> (
+        std::forward<Fs>(fs)...
+    );
+}
+
+
+
+///
+/// TYPE DISPATCH
+///
+
+//
+// visit() calls the visitor with the value viewed as the most specific class
+// the binding has for its kind().  That is done by indexing a table of
+// pointers to functions, one per kind, so there is no chain of isXxx() tests
+// and no dynamic_cast (the value classes have no virtual methods to make
+// that possible anyway).
+//
+// Every entry of the table is instantiated whether or not that kind ever
+// shows up, so the visitor must accept all of the classes below.  Giving it
+// an overload for Value const & as a catch-all is the easy way to do that.
+// Kinds without a class of their own are passed as the nearest general one
+// (e.g. an ISSUE! is passed as an AnyWord, a URL! as an AnyString).
+//
+
+namespace internal {
+
+//
+// The visitor is given an owning T made from the value's cell, so that it
+// can copy what it was given and keep it.  (A borrowed T would look the
+// same to a copy, which would then not keep the series alive; see Ref.)
+// For kinds that aren't refcounted that costs nothing over borrowing, and
+// for the rest it is the same reference a copy of the value would take.
+//
+
+template <typename R, typename F, typename T>
+R visitAs(F & visitor, Value const & value) {
+    T const owned = value.unchecked<T>();
+    return static_cast<R>(visitor(owned));
+}
+
+template <typename R, typename F>
+R visitAsValue(F & visitor, Value const & value) {
+    return static_cast<R>(visitor(value));
+}
+
+} // end namespace internal
+
+
+template <typename R = void, typename F>
+R visit(Value const & value, F && visitor) {
+    using Visitor = typename std::remove_reference<F>::type;
+    using Entry = R (*)(Visitor &, Value const &);
+
+    static Entry const table[] = {
+        &internal::visitAsValue<R, Visitor>, // Other
+        &internal::visitAs<R, Visitor, Unset>,
+        &internal::visitAs<R, Visitor, None>,
+        &internal::visitAs<R, Visitor, Logic>,
+        &internal::visitAs<R, Visitor, Character>,
+        &internal::visitAs<R, Visitor, Integer>,
+        &internal::visitAs<R, Visitor, Float>,
+        &internal::visitAs<R, Visitor, Date>,
+        &internal::visitAsValue<R, Visitor>, // Time
+        &internal::visitAs<R, Visitor, Word>,
+        &internal::visitAs<R, Visitor, SetWord>,
+        &internal::visitAs<R, Visitor, GetWord>,
+        &internal::visitAs<R, Visitor, LitWord>,
+        &internal::visitAs<R, Visitor, Refinement>,
+        &internal::visitAs<R, Visitor, AnyWord>, // Issue
+        &internal::visitAs<R, Visitor, Block>,
+        &internal::visitAs<R, Visitor, Paren>,
+        &internal::visitAs<R, Visitor, Path>,
+        &internal::visitAs<R, Visitor, AnyBlock>, // SetPath
+        &internal::visitAs<R, Visitor, AnyBlock>, // GetPath
+        &internal::visitAs<R, Visitor, AnyBlock>, // LitPath
+        &internal::visitAs<R, Visitor, String>,
+        &internal::visitAs<R, Visitor, Tag>,
+        &internal::visitAs<R, Visitor, AnyString>, // File
+        &internal::visitAs<R, Visitor, AnyString>, // Url
+        &internal::visitAs<R, Visitor, Function>,
+        &internal::visitAs<R, Visitor, Function>, // Native
+        &internal::visitAs<R, Visitor, Function>, // Closure
+        &internal::visitAs<R, Visitor, Function>, // Action
+        &internal::visitAsValue<R, Visitor> // Error
+    };
+
+    static_assert(
+        sizeof(table) / sizeof(Entry) == static_cast<size_t>(Kind::Max),
+        "visit() table out of sync with the list of kinds"
+    );
+
+    return table[static_cast<size_t>(value.kind())](visitor, value);
+}
+
+} // end namespace ren
+
+#endif
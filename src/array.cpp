@@ -0,0 +1,50 @@
+//
+// array.cpp
+// This file is part of RenCpp
+// Copyright (C) 2015 HostileFork.com
+//
+// Licensed under the Boost License, Version 1.0 (the "License")
+//
+//      http://www.boost.org/LICENSE_1_0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.  See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// See http://rencpp.hostilefork.com for more information on this project
+//
+
+#include "rencpp/array.hpp"
+#include "rencpp/context.hpp"
+#include "rencpp/engine.hpp"
+
+namespace ren {
+
+//
+// The pieces of ValueArray that poke at the block's cells are in the
+// binding-specific values files.  Applying is the same for all runtimes.
+//
+
+Value Value::apply(ValueArray const & args, Context * context) const {
+    Value result {Dont::Initialize};
+
+    if (context == nullptr)
+        context = &Context::runFinder(nullptr);
+
+    constructOrApplyInitialize(
+        context->getEngine().getHandle(),
+        context->getHandle(),
+        this,
+        args.cells(),
+        args.size(),
+        sizeof(RenCell),
+        nullptr, // don't construct
+        &result // do apply
+    );
+
+    return result;
+}
+
+} // end namespace ren
@@ -16,8 +16,11 @@
 // See http://rencpp.hostilefork.com for more information on this project
 //
 
+#include <stdexcept>
+
 #include "rencpp/engine.hpp"
 #include "rencpp/context.hpp"
+#include "rencpp/exceptions.hpp"
 
 namespace ren {
 
@@ -70,4 +73,97 @@ Value Runtime::evaluate(
     return result;
 }
 
+
+
+Value const & BatchResult::get() const {
+    if (failed)
+        throw evaluation_error(errorValue);
+    return value;
+}
+
+
+//
+// The results are made before the hook is called so that the cells it
+// writes into have a place to live, but they aren't finalized until it's
+// known which ones succeeded.  Until then they're unsets as far as their
+// destructors are concerned, so nothing is released if we throw.
+//
+
+std::vector<BatchResult> Runtime::evaluateBatch(
+    std::initializer_list<std::initializer_list<internal::Loadable>> requests,
+    Context * context
+) {
+    if (context == nullptr)
+        context = &Context::runFinder(nullptr);
+
+    RenEngineHandle engine = context->getEngine().getHandle();
+
+    // This is an evaluation boundary; see constructOrApplyInitialize
+
+    if (internal::ReleaseQueue::flush(engine) != REN_SUCCESS) {
+        throw std::runtime_error(
+            "Refcounting problem reported by the Ren binding hook"
+        );
+    }
+
+    std::vector<BatchResult> results (requests.size());
+    std::vector<RenConstructOrApplyRequest> hookRequests (requests.size());
+
+    size_t index = 0;
+    for (auto & loadables : requests) {
+        RenConstructOrApplyRequest & request = hookRequests[index];
+
+        request.applicand = nullptr;
+        request.loadablesCell =
+            loadables.size() != 0 ? &loadables.begin()->cell : nullptr;
+        request.numLoadables = loadables.size();
+        request.sizeofLoadable = sizeof(internal::Loadable);
+        request.constructOutDatatypeIn = nullptr; // don't construct
+        request.applyOut = &results[index].value.cell; // do apply
+        request.errorOut = &results[index].errorValue.cell;
+        request.result = REN_SUCCESS;
+
+        index++;
+    }
+
+    auto batchResult = ::RenConstructOrApplyMany(
+        engine,
+        context->getHandle(),
+        hookRequests.data(),
+        hookRequests.size()
+    );
+
+    for (index = 0; index < hookRequests.size(); index++) {
+        switch (hookRequests[index].result) {
+            case REN_SUCCESS:
+                results[index].value.finishInit(engine);
+                break;
+
+            case REN_CONSTRUCT_ERROR:
+            case REN_APPLY_ERROR:
+                results[index].failed = true;
+                results[index].errorValue.finishInit(engine);
+                break;
+
+            case REN_EVALUATION_CANCELLED:
+                break;
+
+            case REN_EVALUATION_EXITED:
+                throw exit_command(
+                    VAL_INT32(&results[index].errorValue.cell)
+                );
+
+            default:
+                throw std::runtime_error(
+                    "Unknown error in RenConstructOrApplyMany"
+                );
+        }
+    }
+
+    if (batchResult == REN_EVALUATION_CANCELLED)
+        throw evaluation_cancelled();
+
+    return results;
+}
+
 }
@@ -0,0 +1,217 @@
+//
+// files.cpp
+// This file is part of RenCpp
+// Copyright (C) 2015 HostileFork.com
+//
+// Licensed under the Boost License, Version 1.0 (the "License")
+//
+//      http://www.boost.org/LICENSE_1_0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.  See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// See http://rencpp.hostilefork.com for more information on this project
+//
+
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "rencpp/engine.hpp"
+#include "rencpp/context.hpp"
+
+namespace ren {
+
+namespace {
+
+//
+// A read-only view of the bytes of a file.  The scanner wants a NUL after
+// the text, and the zero fill at the end of a mapping's last page gives that
+// for free...except when the file's size is an exact multiple of the page
+// size.  Those files (and empty ones, which can't be mapped) are read into a
+// buffer with a terminator added instead.  So are all files on platforms
+// without mmap().
+//
+
+class MappedFile {
+private:
+    void * mapping;
+    size_t mappedSize;
+    std::vector<char> buffer;
+
+public:
+    explicit MappedFile (std::string const & path);
+
+    MappedFile (MappedFile const &) = delete;
+    MappedFile & operator= (MappedFile const &) = delete;
+
+    ~MappedFile ();
+
+    char const * data() const {
+        return mapping
+            ? static_cast<char const *>(mapping)
+            : buffer.data();
+    }
+
+    size_t size() const {
+        return mapping ? mappedSize : buffer.size() - 1;
+    }
+};
+
+
+MappedFile::MappedFile (std::string const & path) :
+    mapping (nullptr),
+    mappedSize (0)
+{
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+        throw std::runtime_error("Couldn't open file " + path);
+
+    struct stat info;
+    if (fstat(fd, &info) == -1) {
+        close(fd);
+        throw std::runtime_error("Couldn't get size of file " + path);
+    }
+
+    size_t size = static_cast<size_t>(info.st_size);
+    size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+    if (size != 0 and size % pageSize != 0) {
+        void * mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            // Scanning goes front to back, one time through
+            madvise(mapped, size, MADV_SEQUENTIAL);
+            mapping = mapped;
+            mappedSize = size;
+        }
+    }
+
+    close(fd);
+
+    if (mapping)
+        return;
+#endif
+
+    std::ifstream in (path, std::ios::in | std::ios::binary);
+    if (not in)
+        throw std::runtime_error("Couldn't open file " + path);
+
+    in.seekg(0, std::ios::end);
+    buffer.resize(static_cast<size_t>(in.tellg()) + 1);
+    in.seekg(0, std::ios::beg);
+    in.read(buffer.data(), static_cast<std::streamsize>(buffer.size() - 1));
+    if (not in)
+        throw std::runtime_error("Couldn't read file " + path);
+
+    buffer.back() = '\0';
+}
+
+
+MappedFile::~MappedFile () {
+#ifndef _WIN32
+    if (mapping)
+        munmap(mapping, mappedSize);
+#endif
+}
+
+
+void loadPhaseTotals(
+    RenEngineHandle engine,
+    int64_t & scanNanoseconds,
+    int64_t & bindNanoseconds
+) {
+    if (
+        RenLoadPhaseTotals(engine, &scanNanoseconds, &bindNanoseconds)
+        != REN_SUCCESS
+    ) {
+        throw std::runtime_error("Couldn't get load timings from the hooks");
+    }
+}
+
+
+//
+// Maps the file and runs the load or evaluation on its bytes, with the time
+// each phase took filled into the timings if they were asked for.
+//
+
+template <class F>
+auto withMappedFile(
+    std::string const & path,
+    Context * context,
+    LoadTimings * timings,
+    F && f
+) -> decltype(f(std::declval<internal::Loadable const &>(), context)) {
+    using std::chrono::steady_clock;
+
+    if (context == nullptr)
+        context = &Context::runFinder(nullptr);
+
+    RenEngineHandle engine = context->getEngine().getHandle();
+
+    auto start = steady_clock::now();
+    MappedFile file {path};
+    auto mapped = steady_clock::now();
+
+    int64_t scanBefore = 0;
+    int64_t bindBefore = 0;
+    if (timings)
+        loadPhaseTotals(engine, scanBefore, bindBefore);
+
+    auto result = f(
+        internal::Loadable {file.data(), file.size(), true}, context
+    );
+
+    if (timings) {
+        int64_t scanAfter;
+        int64_t bindAfter;
+        loadPhaseTotals(engine, scanAfter, bindAfter);
+
+        timings->map = mapped - start;
+        timings->scan = std::chrono::nanoseconds {scanAfter - scanBefore};
+        timings->bind = std::chrono::nanoseconds {bindAfter - bindBefore};
+    }
+
+    return result;
+}
+
+} // end anonymous namespace
+
+
+
+Block Runtime::loadFile(
+    std::string const & path,
+    Context * context,
+    LoadTimings * timings
+) {
+    return withMappedFile(path, context, timings,
+        [](internal::Loadable const & text, Context * context) {
+            return Block {{text}, context};
+        }
+    );
+}
+
+
+Value Runtime::evaluateFile(
+    std::string const & path,
+    Context * context,
+    LoadTimings * timings
+) {
+    return withMappedFile(path, context, timings,
+        [](internal::Loadable const & text, Context * context) {
+            return Runtime::evaluate(&text, 1, context);
+        }
+    );
+}
+
+} // end namespace ren
@@ -0,0 +1,260 @@
+//
+// loader.cpp
+// This file is part of RenCpp
+// Copyright (C) 2015 HostileFork.com
+//
+// Licensed under the Boost License, Version 1.0 (the "License")
+//
+//      http://www.boost.org/LICENSE_1_0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.  See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// See http://rencpp.hostilefork.com for more information on this project
+//
+
+#include <cstddef>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+#include "rencpp/loader.hpp"
+
+namespace ren {
+
+Loader::Loader (std::istream & in, Context * context, size_t chunkSize) :
+    reader (
+        [&in](char * data, size_t size) -> size_t {
+            in.read(data, static_cast<std::streamsize>(size));
+            if (in.bad())
+                throw std::runtime_error("Loader couldn't read its stream");
+            return static_cast<size_t>(in.gcount());
+        }
+    ),
+    context (context),
+    chunkSize (chunkSize),
+    exhausted (false),
+    mode (Mode::Normal),
+    depth (0),
+    braces (0),
+    position (0),
+    boundary (0),
+    current (context),
+    currentPosition (current.begin()),
+    currentEnd (current.end())
+{
+}
+
+
+#ifndef _WIN32
+Loader::Loader (int fd, Context * context, size_t chunkSize) :
+    reader (
+        [fd](char * data, size_t size) -> size_t {
+            while (true) {
+                ssize_t count = read(fd, data, size);
+                if (count >= 0)
+                    return static_cast<size_t>(count);
+                if (errno != EINTR)
+                    throw std::runtime_error("Loader couldn't read its file");
+            }
+        }
+    ),
+    context (context),
+    chunkSize (chunkSize),
+    exhausted (false),
+    mode (Mode::Normal),
+    depth (0),
+    braces (0),
+    position (0),
+    boundary (0),
+    current (context),
+    currentPosition (current.begin()),
+    currentEnd (current.end())
+{
+}
+#endif
+
+
+//
+// Reads up to a chunk more onto the end of the buffer, false at end of input
+//
+
+bool Loader::fill() {
+    if (exhausted)
+        return false;
+
+    size_t start = buffer.size();
+    buffer.resize(start + chunkSize);
+
+    size_t total = 0;
+    while (total < chunkSize) {
+        size_t count = reader(buffer.data() + start + total, chunkSize - total);
+        if (count == 0) {
+            exhausted = true;
+            break;
+        }
+        total += count;
+    }
+
+    buffer.resize(start + total);
+    return total != 0;
+}
+
+
+//
+// Moves the position to the end of the buffer, noting each line break that
+// is outside of any block, paren, string, or comment.  Rebol strings can't
+// span lines, so a line break ends an unterminated one; the scanner will
+// be the one to complain about it.
+//
+
+void Loader::findBoundary() {
+    char const * text = buffer.data();
+    size_t size = buffer.size();
+
+    for (; position < size; position++) {
+        char c = text[position];
+
+        switch (mode) {
+        case Mode::Normal:
+            switch (c) {
+            case '[':
+            case '(':
+                depth++;
+                break;
+
+            case ']':
+            case ')':
+                if (depth != 0)
+                    depth--;
+                break;
+
+            case '"':
+                mode = Mode::Quoted;
+                break;
+
+            case '{':
+                mode = Mode::Braced;
+                braces = 1;
+                break;
+
+            case ';':
+                mode = Mode::Comment;
+                break;
+
+            case '\n':
+                if (depth == 0)
+                    boundary = position + 1;
+                break;
+
+            default:
+                break;
+            }
+            break;
+
+        case Mode::Quoted:
+            if (c == '^')
+                position++; // escaped; may step past the end, that's fine
+            else if (c == '"' or c == '\n')
+                mode = Mode::Normal;
+            break;
+
+        case Mode::Braced:
+            if (c == '^')
+                position++;
+            else if (c == '{')
+                braces++;
+            else if (c == '}' and --braces == 0)
+                mode = Mode::Normal;
+            break;
+
+        case Mode::Comment:
+            if (c == '\n') {
+                mode = Mode::Normal;
+                if (depth == 0)
+                    boundary = position + 1;
+            }
+            break;
+
+        default:
+            UNREACHABLE_CODE();
+        }
+    }
+
+    // An escape as the last byte read leaves the position one past the end,
+    // and the next fill will put the escaped character there.
+}
+
+
+bool Loader::nextChunk(Block & chunk) {
+    while (true) {
+        bool more = fill();
+        findBoundary();
+
+        size_t cut = more ? boundary : buffer.size();
+
+        if (cut == 0) {
+            if (more)
+                continue; // a value longer than a chunk, read the rest
+
+            return false;
+        }
+
+        // The scanner wants a NUL after the text, so one is put where the
+        // cut is and the byte it covers is put back afterward.
+
+        buffer.push_back('\0');
+        char saved = buffer[cut];
+        buffer[cut] = '\0';
+
+        try {
+            chunk = Block {
+                {internal::Loadable {buffer.data(), cut, true}}, context
+            };
+        }
+        catch (...) {
+            buffer[cut] = saved;
+            buffer.pop_back();
+            throw;
+        }
+
+        buffer[cut] = saved;
+        buffer.pop_back();
+
+        buffer.erase(
+            buffer.begin(),
+            buffer.begin() + static_cast<std::ptrdiff_t>(cut)
+        );
+        position -= cut;
+        boundary = 0;
+
+        return true;
+    }
+}
+
+
+//
+// The chunk is walked with an iterator rather than indexed, as indexing a
+// series walks to the index from its head each time.
+//
+
+bool Loader::next(Value & value) {
+    while (currentPosition == currentEnd) {
+        if (not nextChunk(current))
+            return false;
+        currentPosition = current.begin();
+        currentEnd = current.end();
+    }
+
+    value = *currentPosition;
+    ++currentPosition;
+    return true;
+}
+
+} // end namespace ren
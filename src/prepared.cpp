@@ -0,0 +1,94 @@
+//
+// prepared.cpp
+// This file is part of RenCpp
+// Copyright (C) 2015 HostileFork.com
+//
+// Licensed under the Boost License, Version 1.0 (the "License")
+//
+//      http://www.boost.org/LICENSE_1_0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.  See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// See http://rencpp.hostilefork.com for more information on this project
+//
+
+#include <stdexcept>
+
+#include "rencpp/prepared.hpp"
+#include "rencpp/context.hpp"
+#include "rencpp/engine.hpp"
+
+namespace ren {
+
+//
+// Each item is loaded on its own, so that where its values land in the code
+// (and hence where the slots are) is known.  This costs more than loading
+// them all at once, but it's only done when the Prepared is made.
+//
+
+Prepared::Prepared (
+    std::initializer_list<internal::PreparedItem> items,
+    Context * context
+) :
+    context (context ? context : &Context::runFinder(nullptr)),
+    code (items.size(), &this->context->getEngine()),
+    arity (0)
+{
+    for (auto & item : items) {
+        if (item.slot != 0) {
+            slots.emplace_back(item.slot, code.size());
+            code.push_back(unset);
+
+            if (item.slot > arity)
+                arity = item.slot;
+            continue;
+        }
+
+        Block loaded {{item.loadable}, this->context};
+        for (auto value : loaded)
+            code.push_back(value);
+    }
+}
+
+
+Value Prepared::execute(std::initializer_list<Value> args) {
+    if (args.size() != arity)
+        throw std::runtime_error(
+            "Wrong number of arguments given to a Prepared"
+        );
+
+    // Don't keep the arguments alive any longer than the call, whether it
+    // returns or throws (an error, a cancel, or an exit)
+
+    struct SlotResetter {
+        Prepared & prepared;
+        ~SlotResetter () {
+            for (auto & slot : prepared.slots)
+                prepared.code.set(slot.second, unset);
+        }
+    } resetter {*this};
+
+    for (auto & slot : slots)
+        code.set(slot.second, args.begin()[slot.first - 1]);
+
+    Value result {Value::Dont::Initialize};
+
+    Value::constructOrApplyInitialize(
+        context->getEngine().getHandle(),
+        context->getHandle(),
+        nullptr, // no applicand, just evaluate the code
+        code.cells(),
+        code.size(),
+        sizeof(RenCell),
+        nullptr, // don't construct
+        &result // do apply
+    );
+
+    return result;
+}
+
+} // end namespace ren
@@ -87,6 +87,10 @@ static void Do_Rebcode(REBVAL *) {;}
 // Hence we have to forward declare the types before they appear.
 //
 
+extern "C" void Apply_Cells(
+    REBVAL *func, REBSER *where, REBVAL const *cells, REBCNT num, REBCNT stride
+);
+
 extern "C" const REBINT Eval_Type_Map[REB_MAX];
 extern "C" const REBDOF Func_Dispatch[];
 extern "C" const REBACT Value_Dispatch[REB_MAX];
@@ -1423,6 +1427,89 @@ eval_func2:
 }
 
 
+/***********************************************************************
+**
+*/	void Apply_Cells(REBVAL *func, REBSER *where, REBVAL const *cells, REBCNT num, REBCNT stride)
+/*
+**		RenCpp addition.  Like Apply_Block without reduce, but the args
+**		are taken from an array of cells spaced `stride` bytes apart, so
+**		no block has to be made to hold them.  Missing args are padded
+**		out with NONE, but more args than the function takes is an error.
+**
+**		where - block given to the frame as where the call was made
+**
+**		Result is on top of stack.
+**
+***********************************************************************/
+{
+	REBINT ftype = VAL_TYPE(func) - REB_NATIVE; // function type
+	REBCNT dsf;
+
+	REBSER *words;
+	REBINT len;
+	REBINT n;
+	REBINT start;
+	REBVAL *val;
+	REBVAL *args;
+	const REBYTE *cell = reinterpret_cast<const REBYTE *>(cells);
+
+	// Check arity before anything is pushed:
+	words = VAL_FUNC_WORDS(func);
+	len = words ? SERIES_TAIL(words)-1 : 0;
+	if (static_cast<REBINT>(num) > len)
+		Trap_Arg(const_cast<REBVAL *>(
+			reinterpret_cast<const REBVAL *>(cell + len * stride)
+		));
+
+	if (static_cast<REBCNT>(DSP + DSF_BIAS + len + 20) > SERIES_REST(DS_Series))
+		Expand_Stack(len + STACK_MIN);
+
+	// Push function frame:
+	dsf = Push_Func(0, where, 0, 0, func);
+	func = DSF_FUNC(dsf); // for safety
+	start = DSP+1;
+
+	// Copy cells to stack:
+	for (n = 0; n < static_cast<REBINT>(num); n++, cell += stride)
+		DS_PUSH(reinterpret_cast<const REBVAL *>(cell));
+
+	// Pad out missing args:
+	for (; n < len; n++) DS_PUSH_NONE;
+
+	// Validate arguments (same as Apply_Block):
+	if (words) {
+		val = DS_Base + start;
+		for (args = BLK_SKIP(words, 1); NOT_END(args);) {
+			// If arg is refinement, determine its state:
+			if (IS_REFINEMENT(args)) {
+				if (IS_FALSE(val)) {
+					SET_NONE(val);  // ++ ok for none
+					while (TRUE) {
+						val++;
+						args++;
+						if (IS_END(args) || IS_REFINEMENT(args)) break;
+						SET_NONE(val);
+					}
+					continue;
+				}
+				SET_TRUE(val);
+			}
+			// If arg is typed, verify correct argument datatype:
+			if (!TYPE_CHECK(args, VAL_TYPE(val)))
+				Trap3(RE_EXPECT_ARG, Func_Word(dsf), args, Of_Type(val));
+			args++;
+			val++;
+		}
+	}
+
+	// Evaluate the function:
+	DSF = dsf;
+	Func_Dispatch[ftype](func);
+	DSP = dsf;
+	DSF = PRIOR_DSF(dsf);
+}
+
+
 /***********************************************************************
 **
 */	REBVAL *Apply_Function(REBSER *wblk, REBCNT widx, REBVAL *func, va_list args)
@@ -1,7 +1,3 @@
-#ifndef NDEBUG
-#include <unordered_set>
-#include <unordered_map>
-#endif
 #include <cassert>
 #include <stdexcept>
 
@@ -13,6 +9,12 @@
 #include <utility>
 #include <vector>
 #include <algorithm>
+#include <chrono>
+#include <limits>
+#include <list>
+#include <new>
+#include <string>
+#include <unordered_map>
 
 #include <thread>
 
@@ -23,6 +25,11 @@ extern "C" {
 extern jmp_buf * Halt_State;
 void Init_Task_Context();	// Special REBOL values per task
 
+// RenCpp addition in c-do.cpp, apply without an argument block
+void Apply_Cells(
+    REBVAL *func, REBSER *where, REBVAL const *cells, REBCNT num, REBCNT stride
+);
+
 #ifdef TO_WIN32
     #include <windows.h>
     // The objects file from Rebol linked into RenCpp need a
@@ -39,25 +46,56 @@ namespace ren {
 
 namespace internal {
 
-#ifndef NDEBUG
-    std::unordered_map<
-        decltype(RebolEngineHandle::data),
-        std::unordered_map<REBSER const *, unsigned int>
-    > nodes;
-#endif
-
 class RebolHooks {
 
 private:
     RebolEngineHandle theEngine; // currently only support one "Engine"
     REBSER * allocatedContexts;
 
+    REBSER * roots;
+    REBINT rootsFreeHead;
+    size_t rootsLive;
+
+    bool scratchInUse;
+
+    struct ScanCacheEntry {
+        size_t hash;
+        REBSER * context;
+        std::string text;
+        REBCNT slot;
+    };
+
+    using ScanCacheList = std::list<ScanCacheEntry>;
+
+    ScanCacheList scanCacheLru; // most recently used first
+    std::unordered_multimap<size_t, ScanCacheList::iterator> scanCacheIndex;
+    std::vector<REBCNT> scanCacheFreeSlots;
+    size_t scanCacheHits;
+    size_t scanCacheMisses;
+
+    std::chrono::nanoseconds scanTime;
+    std::chrono::nanoseconds bindTime;
+
+    // Text that isn't followed by a NUL is copied here to be scanned
+    std::vector<REBYTE> scanBuffer;
+
 
 public:
     RebolHooks () :
         theEngine (REBOL_ENGINE_HANDLE_INVALID),
-        allocatedContexts (nullptr)
+        allocatedContexts (nullptr),
+        roots (nullptr),
+        rootsFreeHead (-1),
+        rootsLive (0),
+        scratchInUse (false),
+        scanCacheHits (0),
+        scanCacheMisses (0),
+        scanTime (0),
+        bindTime (0)
     {
+        // So that giving a slot back never needs to allocate (see
+        // rememberScan); there are never more slots than entries allowed
+        scanCacheFreeSlots.reserve(scanCacheCapacity);
     }
 
 
@@ -152,6 +190,79 @@ public:
         }
     }
 
+///
+/// GC ROOT REGISTRY
+///
+
+//
+// Any series a C++ handle is holding has to be kept alive through Rebol's
+// garbage collections, even if nothing in Rebol refers to it anymore.  So
+// each handle's series gets a slot in a block that is itself protected, and
+// the GC marks everything in it along with the rest of the roots.
+//
+// A slot that isn't in use holds an INTEGER! with the index of the next free
+// slot (or -1), so the block doubles as its own free list.  The index of a
+// handle's slot rides along in its reference count, and comes back with the
+// cell when it is released, so protecting and unprotecting are both O(1).
+//
+// The block is made and SAVE'd in AllocEngine, where nothing else is on the
+// protect stack, and is never unsaved.  (Unsaving is LIFO, so letting go of
+// it later could unprotect something else instead.)
+//
+// Slots 0 to 2 are not handed out.  They hold the scratch block that
+// ConstructOrApply uses, the blocks of the scan cache, and the empty block
+// that ApplyCells names as where its calls come from.  These are protected
+// the same way but don't count as live.
+//
+
+    static REBCNT const scratchSlot = 0;
+    static REBCNT const scanCacheSlot = 1;
+    static REBCNT const callSiteSlot = 2;
+
+    REBSER * scratch() {
+        return VAL_SERIES(BLK_SKIP(roots, scratchSlot));
+    }
+
+    REBSER * callSite() {
+        return VAL_SERIES(BLK_SKIP(roots, callSiteSlot));
+    }
+
+    size_t Protect(RebolEngineHandle engine, REBVAL const & cell) {
+        UNUSED(engine);
+        assert(roots);
+        assert(ANY_SERIES(&cell));
+
+        REBINT index;
+        if (rootsFreeHead >= 0) {
+            index = rootsFreeHead;
+            REBVAL * slot = BLK_SKIP(roots, index);
+            assert(IS_INTEGER(slot));
+            rootsFreeHead = VAL_INT32(slot);
+            *slot = cell;
+        }
+        else {
+            index = static_cast<REBINT>(SERIES_TAIL(roots));
+            *Append_Value(roots) = cell;
+        }
+
+        rootsLive++;
+        return static_cast<size_t>(index);
+    }
+
+
+    void Unprotect(size_t index) {
+        REBVAL * slot = BLK_SKIP(roots, static_cast<REBCNT>(index));
+        assert(ANY_SERIES(slot));
+
+        SET_INTEGER(slot, rootsFreeHead);
+        rootsFreeHead = static_cast<REBINT>(index);
+
+        assert(rootsLive > 0);
+        rootsLive--;
+    }
+
+
+
 ///
 /// ENGINE ALLOCATION AND FREEING
 ///
@@ -169,6 +280,15 @@ public:
         // The root initialization initializes its thread-locals
         threadsSeen.push_back(std::this_thread::get_id());
 
+        if (not roots) {
+            roots = Make_Block(100);
+            SAVE_SERIES(roots);
+
+            Set_Block(Append_Value(roots), Make_Block(16)); // scratch
+            Set_Block(Append_Value(roots), Make_Block(16)); // scan cache
+            Set_Block(Append_Value(roots), Make_Block(1)); // call site
+        }
+
         theEngine.data = 1020;
         *engineOut = theEngine;
 
@@ -185,6 +305,10 @@ public:
 
         theEngine = REBOL_ENGINE_HANDLE_INVALID;
 
+        // The cached blocks are bound into contexts of this engine
+
+        forgetScans(nullptr, true);
+
         return REN_SUCCESS;
     }
 
@@ -247,6 +371,11 @@ public:
         if (not removed)
             throw std::runtime_error("Couldn't find context in FreeContext");
 
+        // A later context could be allocated at the same address, so scans
+        // bound into this one must not be found by it
+
+        forgetScans(context.series, false);
+
         if (BLK_LEN(allocatedContexts) == 0) {
             // Allow GC
             /*SERIES_CLR_FLAG(allocatedContexts, SER_EXT); */
@@ -347,340 +476,1082 @@ public:
 
 
 ///
-/// CONSTRUCT OR APPLY HOOK
+/// SCAN CACHE
 ///
 
-    //
-    // The ConstructOrApply hook was designed to be a primitive that
-    // allows for efficiency in calling the "Generalized Apply" from
-    // higher level languages like C++.  See notes in runtime.hpp
-    //
-    // Though the primitive was designed for efficient processing without
-    // the need to create series unnecessarily, it is currently in a
-    // "just get the contract settled" state.  Optimizing would likely
-    // best be done by parameterizing the Rebol runtime functions directly
-    //
+//
+// The same text loadables tend to be passed in over and over, e.g. when a
+// string literal like "append" or "either result: parse data rule" is in
+// C++ code that runs for every request.  So the blocks they are scanned and
+// bound into are remembered, keyed by the text and the context they were
+// bound in, and only copied when the same text comes in again.  They are
+// copied deeply because whoever gets the block is free to change it (the
+// code may modify its own literals, for instance).
+//
+// The text itself has to be compared, since the buffer a pointer points to
+// may have been changed or reused by the time it is passed again.  Hashing
+// and comparing it is still much cheaper than the scan.
+//
+// The number of entries is bounded, and the least recently used entry is
+// the one that is dropped to make room.  Large texts (such as whole files)
+// aren't cached at all, as they're rarely loaded twice and keeping a copy
+// of the text to compare against would cost more than it could save.
+// Neither is UTF-16 text, as the cache keeps and compares UTF-8 bytes.
+//
 
-    RenResult ConstructOrApply(
-        RebolEngineHandle engine,
-        RebolContextHandle context,
-        REBVAL const * applicand,
-        REBVAL const * loadablesPtr,
-        size_t numLoadables,
-        size_t sizeofLoadable,
-        REBVAL * constructOutDatatypeIn,
-        REBVAL * applyOut,
-        REBVAL * errorOut
-    ) {
-        lazyThreadInitializeIfNeeded(engine);
+    static size_t const scanCacheCapacity = 256;
 
-        REBOL_STATE state;
+    static REBCNT const scanCacheMaxText = 64 * 1024;
 
-        // Haphazardly copied from c-do.c and Do_String; review needed now
-        // that it is understood better.
-        //
-        //     https://github.com/hostilefork/rencpp/issues/21
+    REBSER * scanCacheBlocks() {
+        return VAL_SERIES(BLK_SKIP(roots, scanCacheSlot));
+    }
 
-        // Unfortunate fact #2, the real Halt_State used by QUIT is a global
-        // shared between Do_String and the exiting function Halt_Code.  And
-        // it's static to c-do.c - that has to be edited to communicate with
-        // Rebol about things like QUIT or Ctrl-C.  (Quit could be replaced
-        // with a new function, but evaluation interrupts can't.)
+    static size_t hashText(REBYTE const * text, REBCNT len) {
+        // FNV-1a
+        size_t hash = static_cast<size_t>(2166136261u);
+        for (REBCNT index = 0; index < len; index++) {
+            hash ^= text[index];
+            hash *= static_cast<size_t>(16777619u);
+        }
+        return hash;
+    }
 
-        bool applying = false;
+//
+// The cache is used inside ConstructOrApply's trap, where a C++ exception
+// must not be thrown: it would unwind past the POP_STATE.  Looking up and
+// dropping entries don't allocate.  Adding one does, so any std::bad_alloc
+// is caught and raised as a Rebol error instead, once the cache has been
+// put back the way it was.
+//
 
-        PUSH_STATE(state, Halt_State);
-        if (SET_JUMP(state)) {
-            POP_STATE(state, Halt_State);
-            Saved_State = Halt_State;
-            Catch_Error(DS_NEXT); // Stores error value here
-            REBVAL *val = Get_System(SYS_STATE, STATE_LAST_ERROR);
-            *val = *DS_NEXT;
-
-            if (VAL_ERR_NUM(val) == RE_QUIT) {
-                // Cancellation to exit to the OS with an error code number,
-                // purposefully requested by the programmer
-                *errorOut = *VAL_ERR_VALUE(DS_NEXT);
-                return REN_EVALUATION_EXITED;
+    REBSER * findScan(
+        size_t hash, REBYTE const * text, REBCNT len, REBSER * context
+    ) {
+        auto range = scanCacheIndex.equal_range(hash);
+        for (auto it = range.first; it != range.second; it++) {
+            ScanCacheList::iterator entry = it->second;
+            if (entry->context != context)
+                continue;
+            if (entry->text.size() != len)
+                continue;
+            if (entry->text.compare(
+                0, len, reinterpret_cast<char const *>(text), len
+            ) != 0) {
+                continue;
             }
 
-            if (VAL_ERR_NUM(val) == RE_HALT) {
-                // cancellation in middle of interpretation from outside
-                // the evaluation loop (e.g. Escape)
-                return REN_EVALUATION_CANCELLED;
-            }
+            scanCacheLru.splice(scanCacheLru.begin(), scanCacheLru, entry);
+            return VAL_SERIES(BLK_SKIP(scanCacheBlocks(), entry->slot));
+        }
+        return nullptr;
+    }
+
+    void rememberScan(
+        size_t hash,
+        REBYTE const * text,
+        REBCNT len,
+        REBSER * context,
+        REBSER * block
+    ) {
+        REBCNT slot;
 
-            // Some other generic error; it may have occurred during the
-            // construct phase or the apply phase
-            *errorOut = *val;
-            if (not applying)
-                return REN_CONSTRUCT_ERROR;
-            return REN_APPLY_ERROR;
+        if (scanCacheLru.size() >= scanCacheCapacity) {
+            ScanCacheList::iterator oldest = std::prev(scanCacheLru.end());
+            dropFromIndex(oldest);
+            slot = oldest->slot;
+            scanCacheLru.erase(oldest);
+        }
+        else if (not scanCacheFreeSlots.empty()) {
+            slot = scanCacheFreeSlots.back();
+            scanCacheFreeSlots.pop_back();
+        }
+        else {
+            slot = SERIES_TAIL(scanCacheBlocks());
+            SET_NONE(Append_Value(scanCacheBlocks()));
         }
-        SET_STATE(state, Halt_State);
 
-        // Use this handler for both, halt conditions (QUIT, HALT) and error
-        // conditions. As this is a top-level handler, simply overwriting
-        // Saved_State is safe.
-        Saved_State = Halt_State;
+        Set_Block(BLK_SKIP(scanCacheBlocks(), slot), block);
 
-        int result = REN_SUCCESS;
+        if (not addScanEntry(hash, text, len, context, slot)) {
+            SET_NONE(BLK_SKIP(scanCacheBlocks(), slot));
+            scanCacheFreeSlots.push_back(slot); // reserved, can't throw
+            Trap0(RE_NO_MEMORY);
+        }
+    }
 
-        if (applicand) {
-            // This is the current rule and the code expects it to be true,
-            // but if it were not what might it mean?  This would be giving
-            // a value but not asking for a result.  It's free to return
-            // the result so this would never be done for performance.
-            assert(applyOut);
+    bool addScanEntry(
+        size_t hash,
+        REBYTE const * text,
+        REBCNT len,
+        REBSER * context,
+        REBCNT slot
+    ) {
+        try {
+            scanCacheLru.push_front(ScanCacheEntry {
+                hash,
+                context,
+                std::string (reinterpret_cast<char const *>(text), len),
+                slot
+            });
+        }
+        catch (std::bad_alloc const &) {
+            return false;
         }
 
-        auto current = reinterpret_cast<volatile char const *>(loadablesPtr);
+        try {
+            scanCacheIndex.emplace(hash, scanCacheLru.begin());
+        }
+        catch (std::bad_alloc const &) {
+            scanCacheLru.pop_front();
+            return false;
+        }
 
-        // Vector is bad to use with setjmp/longjmp, fix this
+        return true;
+    }
 
-        std::vector<std::pair<REBSER *, REBVAL *>> tempSeriesOrValues;
+    void dropFromIndex(ScanCacheList::iterator entry) {
+        auto range = scanCacheIndex.equal_range(entry->hash);
+        for (auto it = range.first; it != range.second; it++) {
+            if (it->second == entry) {
+                scanCacheIndex.erase(it);
+                return;
+            }
+        }
+        UNREACHABLE_CODE();
+    }
 
-        // For the initial state of the binding we'll focus on correctness
-        // instead of optimization.  That means we'll take the "loadables"
-        // and form a block out of them--even when we weren't asked to,
-        // rather than implement a more efficient form of enumeration.
+    // Drop the entries bound in a context (or all of them), letting the GC
+    // have their blocks
 
-        // If we were asked to construct a block type, then this will be
-        // the block we return...as there was no block indicator in the
-        // initial string.  If we were asking to construct a non-block type,
-        // then it should be the first element in this block.
+    void forgetScans(REBSER * context, bool all) {
+        auto it = scanCacheLru.begin();
+        while (it != scanCacheLru.end()) {
+            if (not all and it->context != context) {
+                it++;
+                continue;
+            }
 
-        REBSER * aggregate = Make_Block(static_cast<REBCNT>(numLoadables * 2));
-        SAVE_SERIES(aggregate);
+            dropFromIndex(it);
+            SET_NONE(BLK_SKIP(scanCacheBlocks(), it->slot));
+            scanCacheFreeSlots.push_back(it->slot);
+            it = scanCacheLru.erase(it);
+        }
+    }
 
-        for (size_t index = 0; index < numLoadables; index++) {
+    RebolRuntime::ScanCacheStats scanCacheStats() const {
+        return RebolRuntime::ScanCacheStats {
+            scanCacheHits, scanCacheMisses, scanCacheLru.size()
+        };
+    }
 
-            auto cell = const_cast<REBVAL *>(
-                reinterpret_cast<volatile REBVAL const *>(current)
-            );
+    RenResult LoadPhaseTotals(
+        RebolEngineHandle engine,
+        int64_t * scanNanosecondsOut,
+        int64_t * bindNanosecondsOut
+    ) {
+        if (engine.data != theEngine.data)
+            return REN_BAD_ENGINE_HANDLE;
 
-            if (VAL_TYPE(cell) == REB_END) {
+        *scanNanosecondsOut = scanTime.count();
+        *bindNanosecondsOut = bindTime.count();
+        return REN_SUCCESS;
+    }
 
-                // This is our "Alien" type that wants to get loaded.  Key
-                // to his loading problem is that he wants to know whether
-                // he is an explicit or implicit block type.  So that means
-                // discerning between "foo bar" and "[foo bar]", which we
-                // get through transcode which returns [foo bar] and
-                // [[foo bar]] that discern the cases
 
-                auto loadText = reinterpret_cast<REBYTE*>(cell->data.integer);
 
-                REBSER * transcoded = Scan_Source(
-                    loadText, LEN_BYTES(loadText)
-                );
+///
+/// CONSTRUCT OR APPLY HOOK
+///
 
-                if (not REN_IS_CONTEXT_HANDLE_INVALID(context)) {
-                    // Binding Do_String did by default...except it only
-                    // worked with the user context.  Fell through to lib.
+    //
+    // A text loadable has its UTF-8 pointer and length in the cell, with an
+    // END type as our "Alien" marker.  Key to his loading problem is that
+    // he wants to know whether he is an explicit or implicit block type.  So
+    // that means discerning between "foo bar" and "[foo bar]", which we get
+    // through transcode which returns [foo bar] and [[foo bar]] that
+    // discern the cases.
+    //
+    // Loading is split in steps, so that when several loadables are scanned
+    // in one call they can all be bound at once (see BindScanned).  Blocks
+    // that are handed back aren't protected from the GC, and are the
+    // caller's to modify.  See SCAN CACHE for why they're usually copies.
+    //
 
-                    REBCNT len = context.series->tail;
+    static REBYTE * loadTextOf(REBVAL const * cell) {
+        assert(VAL_TYPE(cell) == REB_END);
+        return reinterpret_cast<REBYTE*>(VAL_SERIES(cell));
+    }
 
-                    Bind_Block(
-                        context.series,
-                        BLK_HEAD(transcoded),
-                        BIND_ALL | BIND_DEEP
-                    );
+    static REBCNT loadLengthOf(REBVAL const * cell) {
+        assert(VAL_TYPE(cell) == REB_END);
+        return VAL_INDEX(cell)
+            & ~(loadableTerminated | loadableSplice | loadableUtf16);
+    }
 
-                    REBVAL vali;
-                    SET_INTEGER(&vali, len);
+    // An END cell can also be a block whose contents are to be spliced in
+    // (see REN() in values.hpp), already scanned and bound
 
-                    Resolve_Context(
-                        context.series, Lib_Context, &vali, FALSE, 0
-                    );
-                }
+    static bool isLoadText(REBVAL const * cell) {
+        return VAL_TYPE(cell) == REB_END
+            and (VAL_INDEX(cell) & loadableSplice) == 0;
+    }
 
-                // Might think to use Append_Block here, but it's under
-                // an #ifdef and apparently unused.  This is its definition.
+    static bool isLoadSplice(REBVAL const * cell) {
+        return VAL_TYPE(cell) == REB_END
+            and (VAL_INDEX(cell) & loadableSplice) != 0;
+    }
 
-                Insert_Series(
-                    aggregate,
-                    aggregate->tail,
-                    reinterpret_cast<REBYTE*>(BLK_HEAD(transcoded)),
-                    transcoded->tail
-                );
-            } else {
-                // Just an ordinary value cell
-                Append_Val(aggregate, cell);
-            }
+    static bool isLoadTerminated(REBVAL const * cell) {
+        assert(VAL_TYPE(cell) == REB_END);
+        return (VAL_INDEX(cell) & loadableTerminated) != 0;
+    }
+
+    static bool isLoadUtf16(REBVAL const * cell) {
+        assert(VAL_TYPE(cell) == REB_END);
+        return (VAL_INDEX(cell) & loadableUtf16) != 0;
+    }
 
-            current += sizeofLoadable;
+    // Scan_Source, with the time it takes added to the total.  The scanner
+    // needs a NUL at the end, so text that doesn't have one (such as a
+    // slice of a bigger buffer) is copied to where one can be added.  It
+    // also needs UTF-8, so UTF-16 text is encoded into the same buffer.
+    // This runs inside a trap, so failing to make room for the copy is
+    // raised as a Rebol error rather than thrown.
+
+    bool copyToScanBuffer(REBYTE const * text, REBCNT len) {
+        try {
+            scanBuffer.assign(text, text + len);
+            scanBuffer.push_back('\0');
+        }
+        catch (std::bad_alloc const &) {
+            return false;
         }
+        return true;
+    }
 
-        if (applyOut) {
-            applying = true;
-            if (applicand) {
-                result = Generalized_Apply(
-                    const_cast<REBVAL *>(applicand),
-                    const_cast<REBSER *>(aggregate),
-                    FALSE,
-                    errorOut
-                );
-                // even if there was an error, we need to keep going and
-                // safely clean things up.
-                if (result == REN_SUCCESS)
-                    *applyOut = *DS_TOP;
-                else
-                    SET_UNSET(applyOut);
-            } else {
-                // Assume that nullptr for applicand means "just do the block
-                // that was in the loadables".  This keeps us from having to
-                // export a version of DO separately.
+    bool encodeToScanBuffer(REBUNI const * text, REBCNT * len) {
+        // Each UTF-16 code unit takes at most 3 bytes of UTF-8
+        try {
+            scanBuffer.resize(static_cast<size_t>(*len) * 3 + 1);
+        }
+        catch (std::bad_alloc const &) {
+            return false;
+        }
 
-                *applyOut = *Do_Blk(aggregate, 0); // result is volatile
+        REBCNT numUnits = *len;
+        *len = Encode_UTF8(
+            scanBuffer.data(),
+            static_cast<REBINT>(numUnits * 3),
+            const_cast<REBUNI *>(text),
+            &numUnits,
+            TRUE,
+            0
+        );
+        scanBuffer[*len] = '\0';
+        return true;
+    }
+
+    REBSER * ScanText(REBVAL const * cell) {
+        REBYTE * text = loadTextOf(cell);
+        REBCNT len = loadLengthOf(cell);
+
+        if (isLoadUtf16(cell)) {
+            if (not encodeToScanBuffer(
+                reinterpret_cast<REBUNI const *>(text), &len
+            )) {
+                Trap0(RE_NO_MEMORY);
             }
+            text = scanBuffer.data();
+        }
+        else if (not isLoadTerminated(cell)) {
+            if (not copyToScanBuffer(text, len))
+                Trap0(RE_NO_MEMORY);
+            text = scanBuffer.data();
         }
 
-        if (constructOutDatatypeIn) {
-            applying = false;
-            REBOL_Types resultType = static_cast<REBOL_Types>(
-                VAL_TYPE(constructOutDatatypeIn)
-            );
-            if (ANY_BLOCK(constructOutDatatypeIn)) {
-                // They actually wanted a constructed value, and they wanted
-                // effectively our aggregate...maybe with a different type.
-                // Depending on how much was set in the "datatype in" we may
-                // not have to rewrite the header bits, as Set_Series does.
-                Set_Series(resultType, constructOutDatatypeIn, aggregate);
-            }
-            else {
-                // If they didn't want a block, then they better want the type
-                // of the first thing in the block.  And there better be
-                // something in that block.
+        auto start = std::chrono::steady_clock::now();
+        REBSER * transcoded = Scan_Source(text, len);
+        scanTime += std::chrono::steady_clock::now() - start;
+        return transcoded;
+    }
 
-                REBCNT len = BLK_LEN(aggregate);
+    static REBSER * bindContextOf(RebolContextHandle context) {
+        return REN_IS_CONTEXT_HANDLE_INVALID(context)
+            ? nullptr
+            : context.series;
+    }
 
-                if (len == 0) {
-                    // Requested construct, but no value came back.
-                    VAL_SET(errorOut, REB_NONE); // improve?
-                    return REN_CONSTRUCT_ERROR;
-                }
+    // Gives back a copy of the cached block for the text, or nullptr
 
-                if (len > 1) {
-                    // Requested construct and more than one value
-                    VAL_SET(errorOut, REB_NONE); // improve?
-                    return REN_CONSTRUCT_ERROR;
-                }
+    REBSER * FindScanned(REBVAL const * cell, RebolContextHandle context) {
+        REBYTE * loadText = loadTextOf(cell);
+        REBCNT len = loadLengthOf(cell);
 
-                *constructOutDatatypeIn = *BLK_HEAD(aggregate);
+        if (len > scanCacheMaxText or isLoadUtf16(cell))
+            return nullptr;
 
-                if (resultType != VAL_TYPE(constructOutDatatypeIn)) {
-                    // Requested construct and value type was wrong
-                    VAL_SET(errorOut, REB_NONE); // improve?
-                    return REN_CONSTRUCT_ERROR;
-                }
-            }
-        }
+        REBSER * cached = findScan(
+            hashText(loadText, len), loadText, len, bindContextOf(context)
+        );
 
-        // Same for our aggregate, though we may have returned it.  If it's
-        // going to be defended from the garbage collector, we need hooks to
-        // be written taking the binding refs into account
+        if (not cached) {
+            scanCacheMisses++;
+            return nullptr;
+        }
 
-        UNSAVE_SERIES(aggregate);
+        scanCacheHits++;
+        return Copy_Block_Values(cached, 0, SERIES_TAIL(cached), TS_SERIES);
+    }
 
-        // Pop our error trapping state
+    // Binding Do_String did by default...except it only worked with the
+    // user context.  Fell through to lib.
+    //
+    // Bind_Block has to index all the words of the context each time it's
+    // called, so it's better to call it once on a block of everything that
+    // was scanned.  Resolve_Context only has to bring in values from lib for
+    // words that were added to the context by the binding, which often is
+    // none of them.
 
-        POP_STATE(state, Halt_State);
-        Saved_State = Halt_State;
+    void BindScanned(REBSER * scanned, RebolContextHandle context) {
+        if (REN_IS_CONTEXT_HANDLE_INVALID(context))
+            return;
 
-        return result;
-    }
+        auto start = std::chrono::steady_clock::now();
 
-    RenResult ReleaseCells(
-        RebolEngineHandle engine,
-        REBVAL const * valuesPtr,
-        size_t numValues,
-        size_t sizeofValue
-    ) {
-        lazyThreadInitializeIfNeeded(engine);
+        REBCNT contextLen = context.series->tail;
 
-        auto current = reinterpret_cast<char const *>(valuesPtr);
-        for (size_t index = 0; index < numValues; index++) {
-            auto cell = const_cast<REBVAL *>(
-                reinterpret_cast<REBVAL const *>(current)
-            );
+        Bind_Block(context.series, BLK_HEAD(scanned), BIND_ALL | BIND_DEEP);
 
-        #ifndef NDEBUG
-            assert(ANY_SERIES(cell));
-            auto it = nodes[engine.data].find(VAL_SERIES(cell));
-            assert(it != nodes[engine.data].end());
-
-            it->second--;
-            if (it->second == 0) {
-                size_t numErased = nodes[engine.data].erase(VAL_SERIES(cell));
-                assert(numErased == 1);
-                if (nodes[engine.data].empty())
-                    nodes.erase(engine.data);
-            }
-        #endif
+        if (context.series->tail != contextLen) {
+            REBVAL vali;
+            SET_INTEGER(&vali, contextLen);
 
-            current += sizeofValue;
+            Resolve_Context(context.series, Lib_Context, &vali, FALSE, 0);
         }
 
-        return REN_SUCCESS;
+        bindTime += std::chrono::steady_clock::now() - start;
     }
 
+    // Caches a block that has been scanned and bound, giving back a copy
 
-    RenResult FormAsUtf8(
-        RebolEngineHandle engine,
-        REBVAL const * value,
-        char * buffer,
-        size_t bufSize,
-        size_t * numBytesOut
+    REBSER * RememberScanned(
+        REBVAL const * cell,
+        RebolContextHandle context,
+        REBSER * bound
     ) {
-        lazyThreadInitializeIfNeeded(engine);
+        REBYTE * loadText = loadTextOf(cell);
+        REBCNT len = loadLengthOf(cell);
 
-#ifndef NDEBUG
-        if (ANY_SERIES(value)) {
-            auto it = nodes.find(engine.data);
-            assert(it != nodes.end());
-            assert(
-                it->second.find(reinterpret_cast<REBSER const *>(
-                    VAL_SERIES(value))
-                )
-                != it->second.end()
-            );
-        }
-#endif
+        if (len > scanCacheMaxText or isLoadUtf16(cell))
+            return bound; // not cached, so nobody else has it
 
-        // First we mold with the "FORM" settings and get a STRING!
-        // series out of that.
+        // Put it in the cache first, which protects it while copying
 
-        REB_MOLD mo;
-        mo.series = nullptr;
-        mo.opts = 0;
-        mo.indent = 0;
-        mo.period = 0;
-        mo.dash = 0;
-        mo.digits = 0;
-        Reset_Mold(&mo);
-        Mold_Value(&mo, const_cast<REBVAL *>(value), 0);
+        rememberScan(
+            hashText(loadText, len),
+            loadText,
+            len,
+            bindContextOf(context),
+            bound
+        );
 
+        return Copy_Block_Values(bound, 0, SERIES_TAIL(bound), TS_SERIES);
+    }
 
-        // Now that we've got our STRING! we need to encode it as UTF8 into
-        // a "shared buffer".  How is that that TO conversions use a shared
-        // buffer and then Set_Series to that, without having a problem?
-        // Who knows, but we've got our own buffer so that's not important.
+    REBSER * ScanLoadable(
+        REBVAL const * cell,
+        RebolContextHandle context
+    ) {
+        if (REBSER * copy = FindScanned(cell, context))
+            return copy;
 
-        REBVAL strValue;
-        Set_Series(REB_STRING, &strValue, mo.series);
+        REBSER * transcoded = ScanText(cell);
 
-        REBSER * utf8 = Encode_UTF8_Value(&strValue, VAL_LEN(&strValue), 0);
+        BindScanned(transcoded, context);
 
+        return RememberScanned(cell, context, transcoded);
+    }
 
-        // Okay that should be the UTF8 data.  Let's copy it into the buffer
-        // the caller sent us.
 
-        REBCNT len = SERIES_LEN(utf8) - 1;
-        *numBytesOut = static_cast<size_t>(len);
+    //
+    // Constructing a non-block type from a single cell (and applying
+    // nothing) is just a type check and a copy, which can't fail in a way
+    // that needs a trap.  Returns false if the request isn't of that form.
+    //
+
+    bool ConstructFromCell(
+        REBVAL const * loadablesPtr,
+        size_t numLoadables,
+        REBVAL * constructOutDatatypeIn,
+        REBVAL * applyOut,
+        REBVAL * errorOut,
+        RenResult & result
+    ) {
+        if (numLoadables != 1 or VAL_TYPE(loadablesPtr) == REB_END)
+            return false;
+
+        if (not constructOutDatatypeIn or applyOut)
+            return false;
+
+        if (ANY_BLOCK(constructOutDatatypeIn))
+            return false;
+
+        if (VAL_TYPE(loadablesPtr) != VAL_TYPE(constructOutDatatypeIn)) {
+            // Requested construct and value type was wrong
+            VAL_SET(errorOut, REB_NONE); // improve?
+            result = REN_CONSTRUCT_ERROR;
+            return true;
+        }
+
+        *constructOutDatatypeIn = *loadablesPtr;
+        result = REN_SUCCESS;
+        return true;
+    }
+
+
+    //
+    // What the error handler needs to know about the request that was in
+    // progress when an error was raised.  It's written after the trap is
+    // set, so it has to be volatile to be trusted after a longjmp.
+    //
+
+    struct Phase {
+        bool usingScratch;
+        bool applying;
+    };
+
+
+    //
+    // Turns the error caught by a trap into the result code for the
+    // request, and cleans up what the request couldn't.  The caller must
+    // have already done the POP_STATE.
+    //
+    // Unfortunate fact #2, the real Halt_State used by QUIT is a global
+    // shared between Do_String and the exiting function Halt_Code.  And
+    // it's static to c-do.c - that has to be edited to communicate with
+    // Rebol about things like QUIT or Ctrl-C.  (Quit could be replaced
+    // with a new function, but evaluation interrupts can't.)
+    //
+
+    RenResult TrappedError(Phase const volatile & phase, REBVAL * errorOut) {
+        Saved_State = Halt_State;
+        Catch_Error(DS_NEXT); // Stores error value here
+        REBVAL *val = Get_System(SYS_STATE, STATE_LAST_ERROR);
+        *val = *DS_NEXT;
+
+        if (phase.usingScratch) {
+            Set_Block(BLK_SKIP(roots, scratchSlot), Make_Block(16));
+            scratchInUse = false;
+        }
+
+        if (VAL_ERR_NUM(val) == RE_QUIT) {
+            // Cancellation to exit to the OS with an error code number,
+            // purposefully requested by the programmer
+            *errorOut = *VAL_ERR_VALUE(DS_NEXT);
+            return REN_EVALUATION_EXITED;
+        }
+
+        if (VAL_ERR_NUM(val) == RE_HALT) {
+            // cancellation in middle of interpretation from outside
+            // the evaluation loop (e.g. Escape)
+            return REN_EVALUATION_CANCELLED;
+        }
+
+        // Some other generic error; it may have occurred during the
+        // construct phase or the apply phase
+        *errorOut = *val;
+        if (not phase.applying)
+            return REN_CONSTRUCT_ERROR;
+        return REN_APPLY_ERROR;
+    }
+
+
+    //
+    // The ConstructOrApply hook was designed to be a primitive that
+    // allows for efficiency in calling the "Generalized Apply" from
+    // higher level languages like C++.  See notes in runtime.hpp
+    //
+    // The general case gathers the loadables into an "aggregate" block to
+    // be applied or constructed from.  A few common cases skip making one:
+    //
+    // * Constructing a non-block type from a single cell (and applying
+    //   nothing) is just a type check and a copy, with no trap needed.
+    //
+    // * A single text loadable is scanned into a block, and that block is
+    //   used as the aggregate instead of being copied into one.
+    //
+    // * When the aggregate isn't going to be handed back as a constructed
+    //   block, a scratch block kept in the root registry is reused for it.
+    //   That is the usual case for applying to cells that are already
+    //   loaded.  Calls that come in while it's busy (e.g. an extension
+    //   function calling back into C++) get a fresh block.  If there's an
+    //   error, the error may refer to the scratch block as where it
+    //   happened...so it is left to the error and a new one is made.
+    //
+    // Optimizing further would likely best be done by parameterizing the
+    // Rebol runtime functions directly.
+    //
+    // This does the work of a request, and must be called with a trap set
+    // that hands errors to TrappedError with the same phase.
+    //
+
+    RenResult ConstructOrApplyTrapped(
+        RebolContextHandle context,
+        REBVAL const * applicand,
+        REBVAL const * loadablesPtr,
+        size_t numLoadables,
+        size_t sizeofLoadable,
+        REBVAL * constructOutDatatypeIn,
+        REBVAL * applyOut,
+        REBVAL * errorOut,
+        Phase volatile & phase
+    ) {
+        phase.usingScratch = false;
+        phase.applying = false;
+
+        RenResult fastResult;
+        if (ConstructFromCell(
+            loadablesPtr,
+            numLoadables,
+            constructOutDatatypeIn,
+            applyOut,
+            errorOut,
+            fastResult
+        )) {
+            return fastResult;
+        }
+
+        bool const singleText = (numLoadables == 1)
+            and isLoadText(loadablesPtr);
+
+        bool const constructingBlock = constructOutDatatypeIn
+            and ANY_BLOCK(constructOutDatatypeIn);
+
+        if (not singleText and not constructingBlock and not scratchInUse) {
+            phase.usingScratch = true;
+            scratchInUse = true;
+        }
+
+        RenResult result = REN_SUCCESS;
+
+        if (applicand) {
+            // This is the current rule and the code expects it to be true,
+            // but if it were not what might it mean?  This would be giving
+            // a value but not asking for a result.  It's free to return
+            // the result so this would never be done for performance.
+            assert(applyOut);
+        }
+
+        // If we were asked to construct a block type, then the aggregate
+        // will be the block we return...as there was no block indicator in
+        // the initial string.  If we were asking to construct a non-block
+        // type, then it should be the only element in the aggregate.
+
+        REBSER * aggregate;
+
+        // With more than one text loadable, the ones that aren't in the scan
+        // cache are all scanned first so that they can be bound together.
+        // `loaded` gets a block for each text loadable in order, and `fresh`
+        // gets just the ones that were scanned (the same series).
+
+        REBSER * loaded = nullptr;
+        REBSER * fresh = nullptr;
+
+        if (singleText) {
+            aggregate = ScanLoadable(loadablesPtr, context);
+            SAVE_SERIES(aggregate);
+        }
+        else {
+            size_t numTexts = 0;
+
+            auto current = reinterpret_cast<volatile char const *>(
+                loadablesPtr
+            );
+
+            for (size_t index = 0; index < numLoadables; index++) {
+                auto cell = reinterpret_cast<volatile REBVAL const *>(
+                    current
+                );
+                if (isLoadText(cell))
+                    numTexts++;
+
+                current += sizeofLoadable;
+            }
+
+            if (numTexts > 1) {
+                loaded = Make_Block(static_cast<REBCNT>(numTexts));
+                SAVE_SERIES(loaded);
+                fresh = Make_Block(static_cast<REBCNT>(numTexts));
+                SAVE_SERIES(fresh);
+
+                current = reinterpret_cast<volatile char const *>(
+                    loadablesPtr
+                );
+
+                for (size_t index = 0; index < numLoadables; index++) {
+                    auto cell = const_cast<REBVAL *>(
+                        reinterpret_cast<volatile REBVAL const *>(current)
+                    );
+                    current += sizeofLoadable;
+
+                    if (not isLoadText(cell))
+                        continue;
+
+                    if (REBSER * copy = FindScanned(cell, context)) {
+                        Set_Block(Append_Value(loaded), copy);
+                        continue;
+                    }
+
+                    REBSER * transcoded = ScanText(cell);
+                    Set_Block(Append_Value(loaded), transcoded);
+                    Set_Block(Append_Value(fresh), transcoded);
+                }
+
+                if (SERIES_TAIL(fresh) != 0)
+                    BindScanned(fresh, context);
+            }
+
+            if (phase.usingScratch) {
+                aggregate = scratch();
+                assert(SERIES_TAIL(aggregate) == 0);
+            }
+            else {
+                aggregate = Make_Block(static_cast<REBCNT>(numLoadables * 2));
+                SAVE_SERIES(aggregate);
+            }
+
+            REBCNT textIndex = 0;
+            REBCNT freshIndex = 0;
+
+            current = reinterpret_cast<volatile char const *>(loadablesPtr);
+
+            for (size_t index = 0; index < numLoadables; index++) {
+
+                auto cell = const_cast<REBVAL *>(
+                    reinterpret_cast<volatile REBVAL const *>(current)
+                );
+
+                if (isLoadSplice(cell)) {
+                    // Cells are copied, but the series they refer to are
+                    // shared with the literal, as in Rebol source
+                    REBSER * spliced = VAL_SERIES(cell);
+                    Insert_Series(
+                        aggregate,
+                        aggregate->tail,
+                        reinterpret_cast<REBYTE*>(BLK_HEAD(spliced)),
+                        spliced->tail
+                    );
+                }
+                else if (VAL_TYPE(cell) == REB_END) {
+                    REBSER * transcoded;
+
+                    if (loaded) {
+                        transcoded = VAL_SERIES(BLK_SKIP(loaded, textIndex));
+                        textIndex++;
+
+                        if (
+                            freshIndex < SERIES_TAIL(fresh)
+                            and VAL_SERIES(BLK_SKIP(fresh, freshIndex))
+                                == transcoded
+                        ) {
+                            freshIndex++;
+                            transcoded = RememberScanned(
+                                cell, context, transcoded
+                            );
+                        }
+                    }
+                    else
+                        transcoded = ScanLoadable(cell, context);
+
+                    // Might think to use Append_Block here, but it's under
+                    // an #ifdef and apparently unused.  This is its
+                    // definition.
+
+                    Insert_Series(
+                        aggregate,
+                        aggregate->tail,
+                        reinterpret_cast<REBYTE*>(BLK_HEAD(transcoded)),
+                        transcoded->tail
+                    );
+                } else {
+                    // Just an ordinary value cell
+                    Append_Val(aggregate, cell);
+                }
+
+                current += sizeofLoadable;
+            }
+        }
+
+        if (applyOut) {
+            phase.applying = true;
+            if (applicand) {
+                result = Generalized_Apply(
+                    const_cast<REBVAL *>(applicand),
+                    const_cast<REBSER *>(aggregate),
+                    FALSE,
+                    errorOut
+                );
+                // even if there was an error, we need to keep going and
+                // safely clean things up.
+                if (result == REN_SUCCESS)
+                    *applyOut = *DS_TOP;
+                else
+                    SET_UNSET(applyOut);
+            } else {
+                // Assume that nullptr for applicand means "just do the block
+                // that was in the loadables".  This keeps us from having to
+                // export a version of DO separately.
+
+                *applyOut = *Do_Blk(aggregate, 0); // result is volatile
+            }
+        }
+
+        if (constructOutDatatypeIn) {
+            phase.applying = false;
+            REBOL_Types resultType = static_cast<REBOL_Types>(
+                VAL_TYPE(constructOutDatatypeIn)
+            );
+            if (ANY_BLOCK(constructOutDatatypeIn)) {
+                // They actually wanted a constructed value, and they wanted
+                // effectively our aggregate...maybe with a different type.
+                // Depending on how much was set in the "datatype in" we may
+                // not have to rewrite the header bits, as Set_Series does.
+                Set_Series(resultType, constructOutDatatypeIn, aggregate);
+            }
+            else {
+                // If they didn't want a block, then they better want the type
+                // of the first thing in the block.  And there better be
+                // something in that block.
+
+                // Errors fall through to the cleanup below, so the aggregate
+                // and trap state are released (and the scratch block freed
+                // up for the next call).
+
+                REBCNT len = BLK_LEN(aggregate);
+
+                if (len != 1) {
+                    // Requested construct, but no value or more than one
+                    // value came back.
+                    VAL_SET(errorOut, REB_NONE); // improve?
+                    result = REN_CONSTRUCT_ERROR;
+                }
+                else if (resultType != VAL_TYPE(BLK_HEAD(aggregate))) {
+                    // Requested construct and value type was wrong
+                    VAL_SET(errorOut, REB_NONE); // improve?
+                    result = REN_CONSTRUCT_ERROR;
+                }
+                else
+                    *constructOutDatatypeIn = *BLK_HEAD(aggregate);
+            }
+        }
+
+        // Same for our aggregate, though we may have returned it.  If it's
+        // going to be defended from the garbage collector, we need hooks to
+        // be written taking the binding refs into account
+
+        if (phase.usingScratch) {
+            RESET_SERIES(aggregate);
+            scratchInUse = false;
+        }
+        else
+            UNSAVE_SERIES(aggregate);
+
+        if (loaded) {
+            UNSAVE_SERIES(fresh);
+            UNSAVE_SERIES(loaded);
+        }
+
+        return result;
+    }
+
+
+    RenResult ConstructOrApply(
+        RebolEngineHandle engine,
+        RebolContextHandle context,
+        REBVAL const * applicand,
+        REBVAL const * loadablesPtr,
+        size_t numLoadables,
+        size_t sizeofLoadable,
+        REBVAL * constructOutDatatypeIn,
+        REBVAL * applyOut,
+        REBVAL * errorOut
+    ) {
+        lazyThreadInitializeIfNeeded(engine);
+
+        RenResult result;
+
+        if (ConstructFromCell(
+            loadablesPtr,
+            numLoadables,
+            constructOutDatatypeIn,
+            applyOut,
+            errorOut,
+            result
+        )) {
+            return result;
+        }
+
+        REBOL_STATE state;
+        Phase volatile phase {false, false};
+
+        // Haphazardly copied from c-do.c and Do_String; review needed now
+        // that it is understood better.
+        //
+        //     https://github.com/hostilefork/rencpp/issues/21
+
+        PUSH_STATE(state, Halt_State);
+        if (SET_JUMP(state)) {
+            POP_STATE(state, Halt_State);
+            return TrappedError(phase, errorOut);
+        }
+        SET_STATE(state, Halt_State);
+
+        // Use this handler for both, halt conditions (QUIT, HALT) and error
+        // conditions. As this is a top-level handler, simply overwriting
+        // Saved_State is safe.
+        Saved_State = Halt_State;
+
+        result = ConstructOrApplyTrapped(
+            context,
+            applicand,
+            loadablesPtr,
+            numLoadables,
+            sizeofLoadable,
+            constructOutDatatypeIn,
+            applyOut,
+            errorOut,
+            phase
+        );
+
+        // Pop our error trapping state
+
+        POP_STATE(state, Halt_State);
+        Saved_State = Halt_State;
+
+        return result;
+    }
+
+
+    //
+    // When a function is applied to nothing but value cells, there's no
+    // need for an aggregate block at all.  Apply_Cells (a RenCpp addition
+    // to c-do.cpp) pushes the cells straight onto the stack as the frame's
+    // arguments, checks them against the function's spec, and dispatches.
+    // Arguments are taken as-is and not evaluated, and passing more of them
+    // than the function takes is an error.  Only Function::call() asks for
+    // this; apply() goes through ConstructOrApply as it always has.
+    //
+
+    RenResult ApplyCells(
+        RebolEngineHandle engine,
+        REBVAL const * applicand,
+        REBVAL const * cellsPtr,
+        size_t numCells,
+        size_t sizeofCell,
+        REBVAL * applyOut,
+        REBVAL * errorOut
+    ) {
+        lazyThreadInitializeIfNeeded(engine);
+
+        assert(ANY_FUNC(applicand));
+
+        REBOL_STATE state;
+        Phase volatile phase {false, true};
+
+        PUSH_STATE(state, Halt_State);
+        if (SET_JUMP(state)) {
+            POP_STATE(state, Halt_State);
+            return TrappedError(phase, errorOut);
+        }
+        SET_STATE(state, Halt_State);
+        Saved_State = Halt_State;
+
+        // The frame wants a block for where the call came from, for error
+        // reporting.  There isn't one, and it mustn't be one an error could
+        // show the binding's own data from, so it's a protected empty block.
+        Apply_Cells(
+            const_cast<REBVAL *>(applicand),
+            callSite(),
+            cellsPtr,
+            static_cast<REBCNT>(numCells),
+            static_cast<REBCNT>(sizeofCell)
+        );
+
+        *applyOut = *DS_TOP;
+
+        POP_STATE(state, Halt_State);
+        Saved_State = Halt_State;
+
+        return REN_SUCCESS;
+    }
+
+
+    //
+    // Runs a batch of requests under one trap, which only has to be set up
+    // again after a request raises an error.  The index of the request in
+    // progress is volatile so it can be trusted after the longjmp.
+    //
+
+    RenResult ConstructOrApplyMany(
+        RebolEngineHandle engine,
+        RebolContextHandle context,
+        RenConstructOrApplyRequest * requests,
+        size_t numRequests
+    ) {
+        lazyThreadInitializeIfNeeded(engine);
+
+        REBOL_STATE state;
+        Phase volatile phase {false, false};
+        size_t volatile index = 0;
+
+        // Each request leaves its result on the data stack, where it stays
+        // until the POP_STATE unless dropped.  It has been copied out by
+        // then, so the stack is put back after each request, or a big batch
+        // would grow it by an entry per request.
+
+        REBINT const dsp = DSP;
+
+        while (index < numRequests) {
+            PUSH_STATE(state, Halt_State);
+            if (SET_JUMP(state)) {
+                POP_STATE(state, Halt_State);
+
+                RenConstructOrApplyRequest & request = requests[index];
+                request.result = TrappedError(phase, request.errorOut);
+                index++;
+
+                if (
+                    request.result == REN_EVALUATION_EXITED
+                    or request.result == REN_EVALUATION_CANCELLED
+                ) {
+                    for (size_t rest = index; rest < numRequests; rest++)
+                        requests[rest].result = REN_EVALUATION_CANCELLED;
+                    return request.result;
+                }
+                continue;
+            }
+            SET_STATE(state, Halt_State);
+            Saved_State = Halt_State;
+
+            for (; index < numRequests; index++) {
+                RenConstructOrApplyRequest & request = requests[index];
+                request.result = ConstructOrApplyTrapped(
+                    context,
+                    request.applicand,
+                    request.loadablesCell,
+                    request.numLoadables,
+                    request.sizeofLoadable,
+                    request.constructOutDatatypeIn,
+                    request.applyOut,
+                    request.errorOut,
+                    phase
+                );
+                DSP = dsp;
+            }
+
+            POP_STATE(state, Halt_State);
+            Saved_State = Halt_State;
+        }
+
+        return REN_SUCCESS;
+    }
+
+    RenResult ReleaseCells(
+        RebolEngineHandle engine,
+        REBVAL const * valuesPtr,
+        size_t numValues,
+        size_t sizeofValue
+    ) {
+        lazyThreadInitializeIfNeeded(engine);
+
+        // The C++ side hands over ReleasedCells, which have the index of the
+        // root made for each cell by Protect following it
+
+        assert(sizeofValue == sizeof(ReleasedCell));
+        UNUSED(sizeofValue);
+
+        auto released = reinterpret_cast<ReleasedCell const *>(valuesPtr);
+        for (size_t index = 0; index < numValues; index++) {
+            assert(ANY_SERIES(&released[index].cell));
+            assert(
+                VAL_SERIES(BLK_SKIP(
+                    roots, static_cast<REBCNT>(released[index].rootIndex)
+                ))
+                == VAL_SERIES(&released[index].cell)
+            );
+
+            Unprotect(released[index].rootIndex);
+        }
+
+        return REN_SUCCESS;
+    }
+
+
+    //
+    // Molds the value with the "FORM" settings, giving back the STRING!
+    // series it was molded into (not protected from the GC).
+    //
+
+    REBSER * Form(REBVAL const * value) {
+
+        REB_MOLD mo;
+        mo.series = nullptr;
+        mo.opts = 0;
+        mo.indent = 0;
+        mo.period = 0;
+        mo.dash = 0;
+        mo.digits = 0;
+        Reset_Mold(&mo);
+        Mold_Value(&mo, const_cast<REBVAL *>(value), 0);
+
+        return mo.series;
+    }
+
+
+    //
+    // Forms the value and gives back its UTF-8 encoding in a series, which
+    // is not protected from the GC.  The length comes back separately, as
+    // the series has a terminator that isn't counted.
+    //
+
+    REBSER * FormUtf8(REBVAL const * value, REBCNT * lenOut) {
+
+        // Now that we've got our STRING! we need to encode it as UTF8 into
+        // a "shared buffer".  How is that that TO conversions use a shared
+        // buffer and then Set_Series to that, without having a problem?
+        // Who knows, but we've got our own buffer so that's not important.
+
+        REBVAL strValue;
+        Set_Series(REB_STRING, &strValue, Form(value));
+
+        REBSER * utf8 = Encode_UTF8_Value(&strValue, VAL_LEN(&strValue), 0);
+
+        *lenOut = SERIES_LEN(utf8) - 1;
+        return utf8;
+    }
+
+
+    RenResult FormAsUtf8(
+        RebolEngineHandle engine,
+        REBVAL const * value,
+        char * buffer,
+        size_t bufSize,
+        size_t * numBytesOut
+    ) {
+        lazyThreadInitializeIfNeeded(engine);
+
+        REBCNT len;
+        REBSER * utf8 = FormUtf8(value, &len);
+
+        // Okay that should be the UTF8 data.  Let's copy it into the buffer
+        // the caller sent us.
+
+        *numBytesOut = static_cast<size_t>(len);
 
         RenResult result;
         if (len > bufSize) {
-            len = bufSize;
+            len = static_cast<REBCNT>(bufSize);
             // should copy portion of buffer in anyway
             result = REN_BUFFER_TOO_SMALL;
         }
@@ -688,16 +1559,246 @@ public:
             result = REN_SUCCESS;
         }
 
-        for (REBCNT index = 0; index < len; index++) {
-            buffer[index] = reinterpret_cast<char*>(SERIES_DATA(utf8))[index];
+        memcpy(buffer, SERIES_DATA(utf8), len);
+
+        return result;
+    }
+
+
+    //
+    // Encodes the formed string a piece at a time into a small buffer, and
+    // gives each piece to the sink, so the UTF-8 of the whole thing is never
+    // made.  No more than maxBytes are given; Encode_UTF8 stops short of
+    // splitting a character's bytes at the end of the room it's given, so
+    // the cut falls between characters.  *cutOut says if any was left over.
+    //
+
+    RenResult EncodeToSink(
+        REBSER * formed,
+        size_t maxBytes,
+        RenUtf8SinkPointer sink,
+        void * state,
+        bool * cutOut
+    ) {
+        REBCNT total = SERIES_TAIL(formed);
+        REBFLG uni = BYTE_SIZE(formed) ? FALSE : TRUE;
+
+        REBYTE chunk[4096];
+        REBCNT done = 0;
+        size_t sent = 0;
+
+        while (done < total and sent < maxBytes) {
+            REBCNT len = total - done;
+            void * src = uni
+                ? static_cast<void *>(UNI_SKIP(formed, done))
+                : static_cast<void *>(BIN_SKIP(formed, done));
+
+            size_t room = std::min(sizeof(chunk), maxBytes - sent);
+
+            REBCNT numBytes = Encode_UTF8(
+                chunk, static_cast<REBINT>(room), src, &len, uni, 0
+            );
+            if (len == 0)
+                break; // next character doesn't fit in what's left
+
+            done += len;
+            sent += numBytes;
+
+            RenResult result = sink(
+                state,
+                reinterpret_cast<char const *>(chunk),
+                static_cast<size_t>(numBytes)
+            );
+            if (result != REN_SUCCESS)
+                return result;
+        }
+
+        *cutOut = done < total;
+        return REN_SUCCESS;
+    }
+
+
+    //
+    // R3-Alpha's molder can't be told to quit once it has made enough, or
+    // asked to hand over what it has made so far.  But forming a block is
+    // just forming each of its items with a space between (see
+    // Form_Block_Series), so that is done here an item at a time, and
+    // afterItem is called after each one.  It can take what's in the mold
+    // buffer out (recording how much and the last character, so the spacing
+    // can still be decided), or return false to stop the walk.  Blocks
+    // inside blocks are walked the same way, so the mold buffer need never
+    // hold much more than the biggest single non-block item.  Nesting past
+    // formDepthLimit (which a block that contains itself will reach) is left
+    // to Mold_Value, which knows how to deal with cycles.
+    //
+
+    static const int formDepthLimit = 256;
+
+    struct FormWalk {
+        REB_MOLD mo;
+        REBCNT takenChars; // taken out of the mold buffer by afterItem
+        REBUNI lastTaken;
+
+        FormWalk () :
+            takenChars (0),
+            lastTaken (0)
+        {
+            mo.series = nullptr;
+            mo.opts = 0;
+            mo.indent = 0;
+            mo.period = 0;
+            mo.dash = 0;
+            mo.digits = 0;
+            Reset_Mold(&mo);
+        }
+
+        // Takes everything out of the mold buffer, after it's been used
+        void take() {
+            REBCNT tail = SERIES_TAIL(mo.series);
+            if (tail == 0)
+                return;
+            lastTaken = *UNI_LAST(mo.series);
+            takenChars += tail;
+            RESET_SERIES(mo.series);
+        }
+
+        bool endsInLineBreak() {
+            if (SERIES_TAIL(mo.series) != 0)
+                return *UNI_LAST(mo.series) == LF;
+            return lastTaken == LF;
+        }
+
+        bool isEmpty() {
+            return SERIES_TAIL(mo.series) == 0 and takenChars == 0;
+        }
+    };
+
+    template <class F>
+    bool FormItems(
+        FormWalk & walk,
+        REBVAL const * value,
+        int depth,
+        F & afterItem
+    ) {
+        if (
+            not (IS_BLOCK(value) or IS_PAREN(value))
+            or depth > formDepthLimit
+        ) {
+            Mold_Value(&walk.mo, const_cast<REBVAL *>(value), 0);
+            return afterItem(walk);
+        }
+
+        REBSER * series = VAL_SERIES(value);
+        REBCNT index = VAL_INDEX(value);
+        REBCNT tail = SERIES_TAIL(series);
+
+        for (REBCNT n = index; n < tail; n++) {
+            if (not FormItems(walk, BLK_SKIP(series, n), depth + 1, afterItem))
+                return false;
+
+            if (
+                n + 1 < tail
+                and not walk.isEmpty()
+                and not walk.endsInLineBreak()
+            ) {
+                Append_Byte(walk.mo.series, ' ');
+            }
         }
 
+        return true;
+    }
+
+
+    //
+    // The formed text is given to the sink whenever the mold buffer has
+    // gathered formSinkChunk characters, rather than after every item, so
+    // the sink isn't called for each little INTEGER! of a big block.
+    //
+
+    static REBCNT const formSinkChunk = 4096;
+
+    RenResult FormAsUtf8Sink(
+        RebolEngineHandle engine,
+        REBVAL const * value,
+        RenUtf8SinkPointer sink,
+        void * state
+    ) {
+        lazyThreadInitializeIfNeeded(engine);
+
+        RenResult result = REN_SUCCESS;
+
+        auto giveToSink = [&](FormWalk & walk) -> bool {
+            bool cut;
+            result = EncodeToSink(
+                walk.mo.series,
+                std::numeric_limits<size_t>::max(),
+                sink,
+                state,
+                &cut
+            );
+            walk.take();
+            return result == REN_SUCCESS;
+        };
+
+        auto afterItem = [&](FormWalk & walk) -> bool {
+            if (SERIES_TAIL(walk.mo.series) < formSinkChunk)
+                return true;
+            return giveToSink(walk);
+        };
+
+        FormWalk walk;
+        if (FormItems(walk, value, 0, afterItem))
+            giveToSink(walk);
+
         return result;
     }
 
 
+    //
+    // R3-Alpha has no MOLD/PART, so the bounded form walks the items and
+    // checks after each one whether the budget has been used up.  The work
+    // done is then bounded by the budget plus the size of the biggest
+    // single non-block item.  The budget is counted in characters of the
+    // mold buffer, which can be no more than the number of UTF-8 bytes
+    // they encode to.
+    //
+
+    RenResult FormAsUtf8Part(
+        RebolEngineHandle engine,
+        REBVAL const * value,
+        size_t maxBytes,
+        RenUtf8SinkPointer sink,
+        void * state,
+        int * truncatedOut
+    ) {
+        lazyThreadInitializeIfNeeded(engine);
+
+        REBCNT limit = static_cast<REBCNT>(std::min<size_t>(
+            maxBytes, std::numeric_limits<REBCNT>::max() - 1
+        ));
+
+        auto afterItem = [limit](FormWalk & walk) -> bool {
+            return SERIES_TAIL(walk.mo.series) <= limit;
+        };
+
+        FormWalk walk;
+        bool stopped = not FormItems(walk, value, 0, afterItem);
+
+        bool cut;
+        RenResult result = EncodeToSink(
+            walk.mo.series, maxBytes, sink, state, &cut
+        );
+
+        *truncatedOut = (stopped or cut) ? 1 : 0;
+        return result;
+    }
+
+
+    // There may still be roots live here: Values in globals can outlive
+    // the engine, and what they release after it's freed is never handed
+    // back (see the ReleaseQueue)
+
     ~RebolHooks () {
-        assert(nodes.empty());
     }
 };
 
@@ -705,6 +1806,25 @@ RebolHooks hooks;
 
 } // end namespace internal
 
+
+RebolRuntime::ScanCacheStats RebolRuntime::scanCacheStats() const {
+    return internal::hooks.scanCacheStats();
+}
+
+
+namespace internal {
+
+
+size_t protectCell(RebolEngineHandle engine, REBVAL const & cell) {
+    return hooks.Protect(engine, cell);
+}
+
+void enterRuntime(RebolEngineHandle engine) {
+    hooks.lazyThreadInitializeIfNeeded(engine);
+}
+
+} // end namespace internal
+
 } // end namespace ren
 
 
@@ -766,6 +1886,33 @@ RenResult RenConstructOrApply(
 }
 
 
+RenResult RenConstructOrApplyMany(
+    RebolEngineHandle engine,
+    RebolContextHandle context,
+    RenConstructOrApplyRequest * requests,
+    size_t numRequests
+) {
+    return ren::internal::hooks.ConstructOrApplyMany(
+        engine, context, requests, numRequests
+    );
+}
+
+
+RenResult RenApplyCells(
+    RebolEngineHandle engine,
+    REBVAL const * applicand,
+    REBVAL const * cells,
+    size_t numCells,
+    size_t sizeofCell,
+    REBVAL * applyOut,
+    REBVAL * errorOut
+) {
+    return ren::internal::hooks.ApplyCells(
+        engine, applicand, cells, numCells, sizeofCell, applyOut, errorOut
+    );
+}
+
+
 RenResult RenReleaseCells(
     RebolEngineHandle engine,
     REBVAL const * valuesPtr,
@@ -789,3 +1936,38 @@ RenResult RenFormAsUtf8(
         engine, value, buffer, bufSize, lengthOut
     );
 }
+
+
+RenResult RenFormAsUtf8Sink(
+    RenEngineHandle engine,
+    RenCell const * value,
+    RenUtf8SinkPointer sink,
+    void * state
+) {
+    return ren::internal::hooks.FormAsUtf8Sink(engine, value, sink, state);
+}
+
+
+RenResult RenFormAsUtf8Part(
+    RenEngineHandle engine,
+    RenCell const * value,
+    size_t maxBytes,
+    RenUtf8SinkPointer sink,
+    void * state,
+    int * truncatedOut
+) {
+    return ren::internal::hooks.FormAsUtf8Part(
+        engine, value, maxBytes, sink, state, truncatedOut
+    );
+}
+
+
+RenResult RenLoadPhaseTotals(
+    RenEngineHandle engine,
+    int64_t * scanNanosecondsOut,
+    int64_t * bindNanosecondsOut
+) {
+    return ren::internal::hooks.LoadPhaseTotals(
+        engine, scanNanosecondsOut, bindNanosecondsOut
+    );
+}
@@ -2,6 +2,7 @@
 #include <stdexcept>
 
 #include <csignal>
+#include <cstring>
 #include <unistd.h>
 
 #include "rencpp/engine.hpp"
@@ -23,16 +24,61 @@ RebolRuntime runtime {true};
 namespace internal {
 
 Loadable::Loadable (char const * sourceCstr) :
+    Loadable (sourceCstr, strlen(sourceCstr), true)
+{
+}
+
+
+Loadable::Loadable (char const * source, size_t length, bool terminated) :
     Value (Value::Dont::Initialize)
 {
-    // using REB_END as our "alien"
+    if (length >= loadableUtf16)
+        throw std::runtime_error("Text is too long to load in one piece");
+
+    // using REB_END as our "alien".  The text pointer and its length go
+    // where a series and index would, so the hooks don't have to strlen()
     VAL_SET(&cell, REB_END);
-    cell.data.integer = evilPointerToInt32Cast(sourceCstr);
+    VAL_SERIES(&cell) = reinterpret_cast<REBSER *>(const_cast<char *>(source));
+    VAL_INDEX(&cell) = static_cast<REBCNT>(length)
+        | (terminated ? loadableTerminated : 0);
 
     refcountPtr = nullptr;
     origin = REN_ENGINE_HANDLE_INVALID;
 }
 
+
+Loadable::Loadable (char16_t const * source, size_t length) :
+    Value (Value::Dont::Initialize)
+{
+    if (length >= loadableUtf16)
+        throw std::runtime_error("Text is too long to load in one piece");
+
+    VAL_SET(&cell, REB_END);
+    VAL_SERIES(&cell) = reinterpret_cast<REBSER *>(
+        const_cast<char16_t *>(source)
+    );
+    VAL_INDEX(&cell) = static_cast<REBCNT>(length) | loadableUtf16;
+
+    refcountPtr = nullptr;
+    origin = REN_ENGINE_HANDLE_INVALID;
+}
+
+
+Loadable::Loadable (Splice const &, AnyBlock const & block) :
+    Value (Value::Dont::Initialize)
+{
+    // The series goes in an END cell as text's pointer does.  It doesn't
+    // take a reference, so the block has to outlive the call (REN()'s do).
+    assert(VAL_INDEX(&block.cell) == 0);
+
+    VAL_SET(&cell, REB_END);
+    VAL_SERIES(&cell) = VAL_SERIES(&block.cell);
+    VAL_INDEX(&cell) = loadableSplice;
+
+    refcountPtr = nullptr;
+    origin = block.origin;
+}
+
 } // end namespace internal
 
 
@@ -1,8 +1,13 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <stdexcept>
 
 #include "rencpp/values.hpp"
 #include "rencpp/context.hpp"
 #include "rencpp/engine.hpp"
+#include "rencpp/array.hpp"
 
 #include "rencpp/rebol.hpp"
 
@@ -29,71 +34,68 @@ Value::Value (unset_t const &, Engine * engine) :
     Value (Dont::Initialize)
 {
     SET_UNSET(&cell);
-    finishInit(engine);
+    finishInitImmediate(engine);
 }
 
 Value::Value (none_t const &, Engine * engine) :
     Value (Dont::Initialize)
 {
     SET_NONE(&cell);
-    finishInit(engine);
+    finishInitImmediate(engine);
 }
 
 Value::Value (bool const & someBool, Engine * engine) :
     Value (Dont::Initialize)
 {
     SET_LOGIC(&cell, someBool);
-    finishInit(engine);
+    finishInitImmediate(engine);
 }
 
 Value::Value (char const & c, Engine * engine) :
     Value (Dont::Initialize)
 {
     SET_CHAR(&cell, c);
-    finishInit(engine);
+    finishInitImmediate(engine);
 }
 
 Value::Value (wchar_t const & wc, Engine * engine) :
     Value (Dont::Initialize)
 {
     SET_CHAR(&cell, wc);
-    finishInit(engine);
+    finishInitImmediate(engine);
 }
 
 Value::Value (int const & someInt, Engine * engine) :
     Value (Dont::Initialize)
 {
     SET_INTEGER(&cell, someInt);
-    finishInit(engine);
+    finishInitImmediate(engine);
 }
 
 Value::Value (double const & someDouble, Engine * engine) :
     Value (Dont::Initialize)
 {
     SET_DECIMAL(&cell, someDouble);
-    finishInit(engine);
+    finishInitImmediate(engine);
 }
 
 //
 // The only way the client can get handles of types that need some kind of
 // garbage collection participation right now is if the system gives it to
-// them.  So on the C++ side, they never create series (for instance).  It's
-// a good check of the C++ wrapper to do some reference counting of the
-// series that have been handed back.
+// them.  So on the C++ side, they never create series (for instance).  Each
+// reference count that gets made for a series also makes a GC root for it,
+// which lives until the count goes to zero and the cell is released.  This
+// thread is calling into the runtime to make the root, so it's also where
+// released roots are handed back if enough of them are waiting.
 //
 
 void Value::finishInit(RenEngineHandle engine) {
     if (needsRefcount()) {
-        refcountPtr = new RefcountType (1);
-
-    #ifndef NDEBUG
-        auto it = internal::nodes[engine.data].find(VAL_SERIES(&cell));
-        if (it == internal::nodes[engine.data].end())
-            internal::nodes[engine.data].emplace(VAL_SERIES(&cell), 1);
-        else
-            it->second++;
-    #endif
-
+        internal::ReleaseQueue::flushIfFull(engine);
+        refcountPtr = internal::RefcountPool::allocate();
+        internal::RefcountPool::setRootIndex(
+            refcountPtr, internal::protectCell(engine, cell)
+        );
     } else {
         refcountPtr = nullptr;
     }
@@ -103,6 +105,11 @@ void Value::finishInit(RenEngineHandle engine) {
 
 
 void Value::finishInit(Engine * engine) {
+    if (not needsRefcount()) {
+        finishInitImmediate(engine);
+        return;
+    }
+
     if (not engine)
         engine = &Engine::runFinder();
     finishInit(engine->getHandle());
@@ -150,6 +157,10 @@ bool Value::isDate() const {
     return IS_DATE(&cell);
 }
 
+bool Value::isTime() const {
+    return IS_TIME(&cell);
+}
+
 bool Value::isWord(REBVAL * init) const {
     if (init) {
         VAL_SET(init, REB_WORD);
@@ -199,8 +210,7 @@ bool Value::isIssue(REBVAL * init) const {
 }
 
 bool Value::isAnyWord() const {
-    return IS_WORD(&cell) or IS_SET_WORD(&cell) or IS_GET_WORD(&cell)
-        or IS_LIT_WORD(&cell) or IS_REFINEMENT(&cell) or IS_ISSUE(&cell);
+    return isKindOf(typesets::AnyWord);
 }
 
 bool Value::isBlock(REBVAL * init) const {
@@ -252,17 +262,15 @@ bool Value::isLitPath(REBVAL * init) const {
 }
 
 bool Value::isAnyBlock() const {
-    return IS_BLOCK(&cell) or IS_PAREN(&cell) or IS_PATH(&cell)
-        or IS_SET_PATH(&cell) or IS_GET_PATH(&cell) or IS_LIT_PATH(&cell);
+    return isKindOf(typesets::AnyBlock);
 }
 
 bool Value::isAnyString() const {
-    return IS_STRING(&cell) or IS_TAG(&cell)
-        or IS_FILE(&cell) or IS_URL(&cell);
+    return isKindOf(typesets::AnyString);
 }
 
 bool Value::isSeries() const {
-    return isAnyBlock() or isAnyString() /* or isBinary()*/;
+    return isKindOf(typesets::Series); // binary not yet included
 }
 
 bool Value::isString(REBVAL * init) const {
@@ -282,14 +290,10 @@ bool Value::isTag(REBVAL * init) const {
 }
 
 bool Value::isFunction() const {
-    // Really, from a user's point of view...shouldn't there only be
-    // ANY_FUNCTION?  It's currently annoying if someone checks for
-    // taking a function and rejects closure.
+    // It's currently annoying if someone checks for taking a function and
+    // rejects closure; see notes on typesets::AnyFunction
 
-    return IS_FUNCTION(&cell)
-        or IS_NATIVE(&cell)
-        or IS_CLOSURE(&cell)
-        or IS_ACTION(&cell);
+    return isKindOf(typesets::AnyFunction);
 }
 
 bool Value::isError() const {
@@ -297,6 +301,42 @@ bool Value::isError() const {
 }
 
 
+Kind Value::kind() const {
+    switch (VAL_TYPE(&cell)) {
+    case REB_UNSET: return Kind::Unset;
+    case REB_NONE: return Kind::None;
+    case REB_LOGIC: return Kind::Logic;
+    case REB_CHAR: return Kind::Character;
+    case REB_INTEGER: return Kind::Integer;
+    case REB_DECIMAL: return Kind::Float;
+    case REB_DATE: return Kind::Date;
+    case REB_TIME: return Kind::Time;
+    case REB_WORD: return Kind::Word;
+    case REB_SET_WORD: return Kind::SetWord;
+    case REB_GET_WORD: return Kind::GetWord;
+    case REB_LIT_WORD: return Kind::LitWord;
+    case REB_REFINEMENT: return Kind::Refinement;
+    case REB_ISSUE: return Kind::Issue;
+    case REB_BLOCK: return Kind::Block;
+    case REB_PAREN: return Kind::Paren;
+    case REB_PATH: return Kind::Path;
+    case REB_SET_PATH: return Kind::SetPath;
+    case REB_GET_PATH: return Kind::GetPath;
+    case REB_LIT_PATH: return Kind::LitPath;
+    case REB_STRING: return Kind::String;
+    case REB_TAG: return Kind::Tag;
+    case REB_FILE: return Kind::File;
+    case REB_URL: return Kind::Url;
+    case REB_FUNCTION: return Kind::Function;
+    case REB_NATIVE: return Kind::Native;
+    case REB_CLOSURE: return Kind::Closure;
+    case REB_ACTION: return Kind::Action;
+    case REB_ERROR: return Kind::Error;
+    default: return Kind::Other;
+    }
+}
+
+
 /////////////////////////////////////////////////////////////////////////////
 
 Logic::operator bool() const {
@@ -445,6 +485,30 @@ QString AnyString::spellingOf_QT() const {
 
 
 
+AnyString::View AnyString::view() const {
+    static_assert(
+        sizeof(REBUNI) == sizeof(char16_t),
+        "Wide strings are expected to hold UCS-2 code units"
+    );
+
+    REBSER * series = VAL_SERIES(&cell);
+    REBCNT index = VAL_INDEX(&cell);
+    REBCNT tail = SERIES_TAIL(series);
+    size_t size = index < tail ? static_cast<size_t>(tail - index) : 0;
+
+    if (BYTE_SIZE(series)) {
+        return View {
+            *this, BIN_SKIP(series, index), size, View::Encoding::Latin1
+        };
+    }
+
+    return View {
+        *this, UNI_SKIP(series, index), size, View::Encoding::Ucs2
+    };
+}
+
+
+
 ///
 /// ITERATORS (WORK IN PROGRESS)
 ///
@@ -465,23 +529,26 @@ void ren::internal::Series_::operator--(int) {
     --*this;
 }
 
-Value ren::internal::Series_::operator*() const {
-    Value result {Dont::Initialize};
+Ref<Value> ren::internal::Series_::ref() const {
+    REBVAL element;
 
     if (isAnyString()) {
         // from str_to_char in Rebol source
         SET_CHAR(
-            &result.cell,
+            &element,
             GET_ANY_CHAR(VAL_SERIES(&cell), cell.data.series.index)
         );
     } else if (isAnyBlock()) {
-        result.cell = *VAL_BLK_SKIP(&cell, cell.data.series.index);
+        element = *VAL_BLK_SKIP(&cell, cell.data.series.index);
     } else {
         // Binary and such, would return an integer
         UNREACHABLE_CODE();
     }
-    result.finishInit(origin);
-    return result;
+    return Ref<Value> {element, origin};
+}
+
+Value ren::internal::Series_::operator*() const {
+    return ref(); // promotes to an owning Value
 }
 
 Value ren::internal::Series_::operator->() const {
@@ -504,4 +571,251 @@ size_t Series::length() const {
 }
 
 
+
+///
+/// VALUE ARRAY
+///
+
+//
+// The block is made here directly rather than through the construct hook,
+// so that it can be given its capacity up front.  Nothing in between its
+// creation and finishInit() can trigger a garbage collection.  Since no
+// hook is called, the engine has to be found first (which is what starts
+// the runtime if this is the first thing made), and each method that
+// touches the block makes sure its thread has been set up.
+//
+
+ValueArray::ValueArray (size_t capacity, Engine * engine) :
+    block (Value::construct_<Block>(Value::Dont::Initialize))
+{
+    if (not engine)
+        engine = &Engine::runFinder();
+    internal::enterRuntime(engine->getHandle());
+
+    Set_Block(&block.cell, Make_Block(static_cast<REBCNT>(capacity)));
+    block.finishInit(engine);
+}
+
+size_t ValueArray::size() const {
+    return static_cast<size_t>(SERIES_TAIL(VAL_SERIES(&block.cell)));
+}
+
+void ValueArray::push_back(Value const & value) {
+    internal::enterRuntime(block.origin);
+    *Append_Value(VAL_SERIES(&block.cell)) = value.cell;
+}
+
+Value ValueArray::operator[](size_t index) const {
+    assert(index < size());
+    return Value::construct_<Value>(
+        *BLK_SKIP(VAL_SERIES(&block.cell), static_cast<REBCNT>(index)),
+        block.origin
+    );
+}
+
+void ValueArray::set(size_t index, Value const & value) {
+    assert(index < size());
+    internal::enterRuntime(block.origin);
+    *BLK_SKIP(VAL_SERIES(&block.cell), static_cast<REBCNT>(index)) =
+        value.cell;
+}
+
+void ValueArray::clear() {
+    internal::enterRuntime(block.origin);
+    RESET_SERIES(VAL_SERIES(&block.cell));
+}
+
+RenCell const * ValueArray::cells() const {
+    return BLK_HEAD(VAL_SERIES(&block.cell));
+}
+
+
+
+///
+/// FORMING IMMEDIATES
+///
+
+//
+// The hooks form a value by setting up a REB_MOLD, molding into a STRING!
+// series, and encoding that as UTF-8...which is a lot of work for an
+// INTEGER!.  These give the same bytes as Mold_Value does with the FORM
+// settings, but without the runtime.  A value with any question about how
+// it would come out (a negative zero, an UNSET!, a NUL character) is left
+// to the hooks.  The form-conformance test holds these to what the runtime
+// makes of the same values.
+//
+
+namespace internal {
+
+namespace {
+
+size_t formLiteral(char const * literal, char * buffer) {
+    size_t len = std::strlen(literal);
+    std::memcpy(buffer, literal, len);
+    return len;
+}
+
+
+size_t formInteger(REBI64 i, char * buffer) {
+    char digits[20];
+    size_t numDigits = 0;
+
+    // Work with the magnitude as unsigned, so the most negative integer
+    // doesn't overflow when it's negated
+    uint64_t magnitude = i < 0
+        ? static_cast<uint64_t>(0) - static_cast<uint64_t>(i)
+        : static_cast<uint64_t>(i);
+
+    do {
+        digits[numDigits++] = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+
+    char * out = buffer;
+    if (i < 0)
+        *out++ = '-';
+    while (numDigits != 0)
+        *out++ = digits[--numDigits];
+    return static_cast<size_t>(out - buffer);
+}
+
+
+//
+// Emit_Decimal asks dtoa for the shortest digits that read back as the same
+// double, and if there are more than the 15 significant digits FORM shows,
+// for 15 digits rounded.  Rounding to 15 digits with printf and dropping
+// trailing zeros gives the same thing either way: a double whose shortest
+// digits number 15 or fewer rounds to exactly those digits.  Those digits
+// are then laid out as Emit_Decimal does, in exponent form for magnitudes
+// past the digits shown or under a millionth.
+//
+
+int const formDecimalDigits = 15;
+
+bool formDecimal(REBDEC d, char * buffer, size_t & numBytes) {
+    if (not std::isfinite(d) or (d == 0 and std::signbit(d)))
+        return false;
+
+    char scientific[32];
+    snprintf(
+        scientific, sizeof(scientific), "%.*e", formDecimalDigits - 1, d
+    );
+
+    // e.g. "-1.23450000000000e+05"
+    char const * p = scientific;
+    bool negative = (*p == '-');
+    if (negative)
+        p++;
+
+    // The radix printf writes follows LC_NUMERIC (it may be a comma, or
+    // more than one byte), so anything that isn't a digit is skipped
+    char digits[formDecimalDigits];
+    int numDigits = 0;
+    for (; *p != 'e'; p++) {
+        if (*p >= '0' and *p <= '9' and numDigits < formDecimalDigits)
+            digits[numDigits++] = *p;
+    }
+    while (numDigits > 1 and digits[numDigits - 1] == '0')
+        numDigits--;
+
+    // dtoa's exponent, for 0.DDD times ten to the e
+    int e = std::atoi(p + 1) + 1;
+
+    char * out = buffer;
+    if (negative)
+        *out++ = '-';
+
+    if (e > formDecimalDigits or e < -6) {
+        *out++ = digits[0];
+        if (numDigits > 1) {
+            *out++ = '.';
+            std::memcpy(out, digits + 1, static_cast<size_t>(numDigits - 1));
+            out += numDigits - 1;
+        }
+        out += snprintf(out, 8, "e%d", e - 1);
+    }
+    else if (e > 0) {
+        if (e < numDigits) {
+            std::memcpy(out, digits, static_cast<size_t>(e));
+            out += e;
+            *out++ = '.';
+            std::memcpy(out, digits + e, static_cast<size_t>(numDigits - e));
+            out += numDigits - e;
+        }
+        else {
+            std::memcpy(out, digits, static_cast<size_t>(numDigits));
+            out += numDigits;
+            std::memset(out, '0', static_cast<size_t>(e - numDigits));
+            out += e - numDigits;
+            *out++ = '.';
+            *out++ = '0';
+        }
+    }
+    else {
+        *out++ = '0';
+        *out++ = '.';
+        std::memset(out, '0', static_cast<size_t>(-e));
+        out += -e;
+        std::memcpy(out, digits, static_cast<size_t>(numDigits));
+        out += numDigits;
+    }
+
+    numBytes = static_cast<size_t>(out - buffer);
+    return true;
+}
+
+
+size_t formCharacter(REBUNI uni, char * buffer) {
+    uint32_t c = uni;
+    if (c < 0x80) {
+        buffer[0] = static_cast<char>(c);
+        return 1;
+    }
+    if (c < 0x800) {
+        buffer[0] = static_cast<char>(0xC0 | (c >> 6));
+        buffer[1] = static_cast<char>(0x80 | (c & 0x3F));
+        return 2;
+    }
+    buffer[0] = static_cast<char>(0xE0 | (c >> 12));
+    buffer[1] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+    buffer[2] = static_cast<char>(0x80 | (c & 0x3F));
+    return 3;
+}
+
+} // end anonymous namespace
+
+
+bool formImmediate(RenCell const & cell, char * buffer, size_t & numBytes) {
+    switch (VAL_TYPE(&cell)) {
+    case REB_NONE:
+        numBytes = formLiteral("none", buffer);
+        return true;
+
+    case REB_LOGIC:
+        numBytes = formLiteral(VAL_LOGIC(&cell) ? "true" : "false", buffer);
+        return true;
+
+    case REB_INTEGER:
+        numBytes = formInteger(VAL_INT64(&cell), buffer);
+        return true;
+
+    case REB_DECIMAL:
+        return formDecimal(VAL_DECIMAL(&cell), buffer, numBytes);
+
+    case REB_CHAR: {
+        REBUNI uni = VAL_CHAR(&cell);
+        if (uni == 0 or (uni >= 0xD800 and uni <= 0xDFFF))
+            return false;
+        numBytes = formCharacter(uni, buffer);
+        return true;
+    }
+
+    default:
+        return false;
+    }
+}
+
+} // end namespace internal
+
+
 } // end namespace ren
@@ -25,6 +25,7 @@
 #include <cstring>
 #include <sstream>
 #endif
+#include <algorithm>
 #include <cassert>
 
 #include "rencpp/red.hpp"
@@ -119,10 +120,16 @@ public:
                 RenFormAsUtf8(engine, &cell, buffer, 256, &length);
                 print("LOADED:", buffer);
             }
+            else if (cell.s.data3 == 2) {
+                print("PENDING UTF-16:", cell.s.data2, "code units");
+            }
             else {
                 print(
                     "PENDING:",
-                    evilInt32ToPointerCast<char*>(cell.data1)
+                    std::string (
+                        evilInt32ToPointerCast<char*>(cell.data1),
+                        static_cast<size_t>(cell.s.data2)
+                    )
                 );
             }
 
@@ -198,6 +205,40 @@ public:
         return REN_SUCCESS;
     }
 
+    RenResult FormAsUtf8Sink(
+        RedEngineHandle engine,
+        RedCell const * value,
+        RenUtf8SinkPointer sink,
+        void * state
+    ) {
+        char buffer[256];
+        size_t length;
+        RenResult result = FormAsUtf8(engine, value, buffer, 256, &length);
+        if (result != REN_SUCCESS)
+            return result;
+
+        return sink(state, buffer, length);
+    }
+
+    RenResult FormAsUtf8Part(
+        RedEngineHandle engine,
+        RedCell const * value,
+        size_t maxBytes,
+        RenUtf8SinkPointer sink,
+        void * state,
+        int * truncatedOut
+    ) {
+        char buffer[256];
+        size_t length;
+        RenResult result = FormAsUtf8(engine, value, buffer, 256, &length);
+        if (result != REN_SUCCESS)
+            return result;
+
+        // The fake forms are plain ASCII, so any cut is between characters
+        *truncatedOut = length > maxBytes ? 1 : 0;
+        return sink(state, buffer, std::min(length, maxBytes));
+    }
+
     ~FakeRedHooks() {
     }
 };
@@ -265,6 +306,52 @@ RenResult RenConstructOrApply(
 }
 
 
+RenResult RenConstructOrApplyMany(
+    RenEngineHandle engine,
+    RenContextHandle context,
+    RenConstructOrApplyRequest * requests,
+    size_t numRequests
+) {
+    for (size_t index = 0; index < numRequests; index++) {
+        RenConstructOrApplyRequest & request = requests[index];
+        request.result = ren::internal::hooks.ConstructOrApply(
+            engine,
+            context,
+            request.applicand,
+            const_cast<RenCell *>(request.loadablesCell),
+            request.numLoadables,
+            request.sizeofLoadable,
+            request.constructOutDatatypeIn,
+            request.applyOut
+        );
+    }
+    return REN_SUCCESS;
+}
+
+
+RenResult RenApplyCells(
+    RenEngineHandle engine,
+    RenCell const * applicand,
+    RenCell const * cells,
+    size_t numCells,
+    size_t sizeofCell,
+    RenCell * applyOut,
+    RenCell * errorOut
+) {
+    UNUSED(errorOut);
+    return ren::internal::hooks.ConstructOrApply(
+        engine,
+        RED_CONTEXT_HANDLE_INVALID,
+        applicand,
+        const_cast<RenCell *>(cells),
+        numCells,
+        sizeofCell,
+        nullptr,
+        applyOut
+    );
+}
+
+
 RenResult RenReleaseCells(
     RenEngineHandle handle,
     RenCell cells[],
@@ -293,4 +380,40 @@ RenResult RenFormAsUtf8(
     );
 }
 
+
+
+RenResult RenFormAsUtf8Sink(
+    RenEngineHandle engine,
+    RenCell const * value,
+    RenUtf8SinkPointer sink,
+    void * state
+) {
+    return ren::internal::hooks.FormAsUtf8Sink(engine, value, sink, state);
+}
+
+
+RenResult RenFormAsUtf8Part(
+    RenEngineHandle engine,
+    RenCell const * value,
+    size_t maxBytes,
+    RenUtf8SinkPointer sink,
+    void * state,
+    int * truncatedOut
+) {
+    return ren::internal::hooks.FormAsUtf8Part(
+        engine, value, maxBytes, sink, state, truncatedOut
+    );
+}
+
+
+RenResult RenLoadPhaseTotals(
+    RenEngineHandle,
+    int64_t * scanNanosecondsOut,
+    int64_t * bindNanosecondsOut
+) {
+    *scanNanosecondsOut = 0;
+    *bindNanosecondsOut = 0;
+    return REN_SUCCESS;
+}
+
 #endif
@@ -1,3 +1,4 @@
+#include <cstring>
 #include <iostream>
 #include <sstream>
 
@@ -17,18 +18,51 @@ Runtime & runtimeRef = runtime;
 
 
 internal::Loadable::Loadable (char const * sourceCstr) :
+    Loadable (sourceCstr, strlen(sourceCstr), true)
+{
+}
+
+
+internal::Loadable::Loadable (
+    char const * source,
+    size_t length,
+    bool terminated
+) :
+    Value (Value::Dont::Initialize)
+{
+    cell = RedRuntime::makeCell4(
+        RedRuntime::TYPE_ALIEN,
+        evilPointerToInt32Cast(source),
+        static_cast<int32_t>(length),
+        terminated ? 1 : 0
+    );
+    refcountPtr = nullptr;
+    origin = REN_ENGINE_HANDLE_INVALID;
+}
+
+
+internal::Loadable::Loadable (char16_t const * source, size_t length) :
     Value (Value::Dont::Initialize)
 {
+    // The last field says the text is UTF-16 (2) rather than UTF-8
     cell = RedRuntime::makeCell4(
         RedRuntime::TYPE_ALIEN,
-        evilPointerToInt32Cast(sourceCstr),
-        0, 0
+        evilPointerToInt32Cast(source),
+        static_cast<int32_t>(length),
+        2
     );
     refcountPtr = nullptr;
     origin = REN_ENGINE_HANDLE_INVALID;
 }
 
 
+internal::Loadable::Loadable (Splice const &, AnyBlock const & block) :
+    // The fake hooks don't evaluate anything, so the block is just passed
+    Loadable (static_cast<Value const &>(block))
+{
+}
+
+
 RedRuntime::DatatypeID RedRuntime::getDatatypeID(RedCell const & cell) {
     // extract the lowest byte
     return static_cast<RedRuntime::DatatypeID>(cell.header & 0xFF);
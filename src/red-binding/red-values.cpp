@@ -11,7 +11,8 @@ namespace ren {
 
 void Value::finishInit(RenEngineHandle engine) {
     if (needsRefcount()) {
-        refcountPtr = new RefcountType (1);
+        internal::ReleaseQueue::flushIfFull(engine);
+        refcountPtr = internal::RefcountPool::allocate();
     } else {
         refcountPtr = nullptr;
     }
@@ -279,6 +280,41 @@ bool Value::isString(RedCell * init) const {
 }
 
 
+Kind Value::kind() const {
+    switch (RedRuntime::getDatatypeID(*this)) {
+        case RedRuntime::TYPE_UNSET: return Kind::Unset;
+        case RedRuntime::TYPE_NONE: return Kind::None;
+        case RedRuntime::TYPE_LOGIC: return Kind::Logic;
+        case RedRuntime::TYPE_CHAR: return Kind::Character;
+        case RedRuntime::TYPE_INTEGER: return Kind::Integer;
+        case RedRuntime::TYPE_FLOAT: return Kind::Float;
+        case RedRuntime::TYPE_WORD: return Kind::Word;
+        case RedRuntime::TYPE_SET_WORD: return Kind::SetWord;
+        case RedRuntime::TYPE_GET_WORD: return Kind::GetWord;
+        case RedRuntime::TYPE_LIT_WORD: return Kind::LitWord;
+        case RedRuntime::TYPE_REFINEMENT: return Kind::Refinement;
+        case RedRuntime::TYPE_ISSUE: return Kind::Issue;
+        case RedRuntime::TYPE_BLOCK: return Kind::Block;
+        case RedRuntime::TYPE_PAREN: return Kind::Paren;
+        case RedRuntime::TYPE_PATH: return Kind::Path;
+        case RedRuntime::TYPE_SET_PATH: return Kind::SetPath;
+        case RedRuntime::TYPE_GET_PATH: return Kind::GetPath;
+        case RedRuntime::TYPE_LIT_PATH: return Kind::LitPath;
+        case RedRuntime::TYPE_STRING: return Kind::String;
+        case RedRuntime::TYPE_FILE: return Kind::File;
+        case RedRuntime::TYPE_URL: return Kind::Url;
+        case RedRuntime::TYPE_FUNCTION: return Kind::Function;
+        case RedRuntime::TYPE_NATIVE: return Kind::Native;
+        case RedRuntime::TYPE_CLOSURE: return Kind::Closure;
+        case RedRuntime::TYPE_ACTION: return Kind::Action;
+        case RedRuntime::TYPE_ERROR: return Kind::Error;
+        default:
+            break;
+    }
+    return Kind::Other;
+}
+
+
 
 ///
 /// ADDITIONAL CLASS SUPPORT
@@ -325,4 +361,27 @@ void Function::finishInit(
     Value::finishInit(engine.getHandle());
 }
 
+
+AnyString::View AnyString::view() const {
+    throw std::runtime_error("No way to view a RedCell's string data yet.");
+}
+
+
+
+namespace internal {
+
+//
+// Red's FORM doesn't lay out floats as R3-Alpha's does, and nothing has
+// been checked against it, so everything is left to the hooks for now.
+//
+
+bool formImmediate(RenCell const & cell, char * buffer, size_t & numBytes) {
+    UNUSED(cell);
+    UNUSED(buffer);
+    UNUSED(numBytes);
+    return false;
+}
+
+} // end namespace internal
+
 } // end namespace ren
@@ -16,6 +16,10 @@
 // See http://rencpp.hostilefork.com for more information on this project
 //
 
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
 #include <ostream>
 #include <vector>
 
@@ -28,6 +32,358 @@
 namespace ren {
 
 
+///
+/// REFERENCE COUNT POOL
+///
+
+//
+// A slot is either holding a live count, or is threaded onto the free list.
+// The count has to come first, because release() gets handed a pointer to
+// the count and needs to find its way back to the slot.
+//
+
+namespace internal {
+
+namespace {
+
+struct RefcountSlot {
+    RefcountType count;
+    RefcountSlot * next;
+    size_t rootIndex;
+};
+
+static_assert(
+    std::is_standard_layout<RefcountSlot>::value,
+    "RefcountSlot must be standard layout to cast from its count"
+);
+
+size_t const slotsPerSlab = 1024;
+
+// Slots are moved between a thread's own free list and the shared pool this
+// many at a time, so the lock is taken once for that many allocations.
+size_t const slotsPerTransfer = 64;
+
+// When the counts aren't atomic the binding is only being used from one
+// thread, so there's no point in paying for the lock either.
+
+#if REN_REFCOUNT_THREADSAFE
+using PoolLock = std::lock_guard<std::mutex>;
+#else
+struct PoolLock {
+    PoolLock (std::mutex &) {}
+};
+#endif
+
+struct RefcountPoolState {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<RefcountSlot[]>> slabs;
+    RefcountSlot * freeList = nullptr;
+    size_t slotsUsedInLastSlab = slotsPerSlab;
+};
+
+// Values living in globals may be destroyed after anything else in this
+// file, so the pool state is deliberately never freed.
+
+RefcountPoolState & poolState() {
+    static RefcountPoolState * state = new RefcountPoolState;
+    return *state;
+}
+
+
+//
+// Each thread allocates from and releases to a free list of its own, and
+// only goes to the shared pool when that runs out or grows too long.  The
+// list is trivially destructible so that Values in globals can still use it
+// at exit.  Its slots are given back to the pool when the thread exits by
+// a separate object, after which the thread releases to the pool directly.
+//
+
+struct LocalSlots {
+    RefcountSlot * head;
+    size_t count;
+    bool returned;
+};
+
+thread_local LocalSlots localSlots {nullptr, 0, false};
+
+void giveBack(LocalSlots & local, size_t numSlots) {
+    auto & pool = poolState();
+    PoolLock lock {pool.mutex};
+
+    while (numSlots != 0 and local.head) {
+        RefcountSlot * slot = local.head;
+        local.head = slot->next;
+        local.count--;
+        numSlots--;
+
+        slot->next = pool.freeList;
+        pool.freeList = slot;
+    }
+}
+
+struct LocalSlotsReturner {
+    ~LocalSlotsReturner () {
+        giveBack(localSlots, localSlots.count);
+        localSlots.returned = true;
+    }
+};
+
+thread_local LocalSlotsReturner localSlotsReturner;
+
+void refill(LocalSlots & local) {
+    static_cast<void>(&localSlotsReturner); // make sure it's constructed
+
+    auto & pool = poolState();
+    PoolLock lock {pool.mutex};
+
+    for (size_t index = 0; index < slotsPerTransfer; index++) {
+        RefcountSlot * slot;
+        if (pool.freeList) {
+            slot = pool.freeList;
+            pool.freeList = slot->next;
+        }
+        else {
+            if (pool.slotsUsedInLastSlab == slotsPerSlab) {
+                if (local.head)
+                    break; // don't make a slab for the sake of the batch
+                pool.slabs.emplace_back(new RefcountSlot[slotsPerSlab]);
+                pool.slotsUsedInLastSlab = 0;
+            }
+            slot = &pool.slabs.back()[pool.slotsUsedInLastSlab++];
+        }
+
+        slot->next = local.head;
+        local.head = slot;
+        local.count++;
+    }
+}
+
+} // end anonymous namespace
+
+
+#if (REN_REFCOUNT_THREADSAFE == 0) and !defined(NDEBUG)
+std::thread::id RefcountPool::affinity;
+#endif
+
+
+RefcountType * RefcountPool::allocate() {
+    checkAffinity();
+
+    LocalSlots & local = localSlots;
+    if (not local.head)
+        refill(local);
+
+    RefcountSlot * slot = local.head;
+    local.head = slot->next;
+    local.count--;
+
+    slot->next = nullptr;
+    slot->rootIndex = 0;
+    slot->count = 1;
+    return &slot->count;
+}
+
+
+void RefcountPool::release(RefcountType * refcountPtr) {
+    checkAffinity();
+
+    auto slot = reinterpret_cast<RefcountSlot *>(refcountPtr);
+
+    LocalSlots & local = localSlots;
+    slot->next = local.head;
+    local.head = slot;
+    local.count++;
+
+    if (local.returned)
+        giveBack(local, local.count);
+    else if (local.count > 2 * slotsPerTransfer)
+        giveBack(local, slotsPerTransfer);
+}
+
+
+size_t RefcountPool::slabsAllocated() {
+    auto & pool = poolState();
+    PoolLock lock {pool.mutex};
+    return pool.slabs.size();
+}
+
+
+void RefcountPool::setRootIndex(RefcountType * refcountPtr, size_t index) {
+    reinterpret_cast<RefcountSlot *>(refcountPtr)->rootIndex = index;
+}
+
+
+size_t RefcountPool::rootIndex(RefcountType const * refcountPtr) {
+    return reinterpret_cast<RefcountSlot const *>(refcountPtr)->rootIndex;
+}
+
+} // end namespace internal
+
+
+
+///
+/// DEFERRED RELEASE QUEUE
+///
+
+//
+// A handle may be dropped on any thread, but releasing it writes to the
+// runtime's root registry, which only threads calling into the runtime may
+// do.  So defer() just queues the cell, and the queue is given to the hook
+// by threads that are calling into the runtime anyway: at each evaluation
+// boundary, and by flushIfFull() when a new handle is registered.
+//
+// There are rarely more than one or two engines, so the buffers are kept in
+// a vector and found by a linear search.  A buffer keeps its capacity after
+// being flushed, so once it has grown to the batch size no more allocations
+// are made for it.  An engine's buffer is dropped when the engine is freed;
+// anything released after that (e.g. by Values in globals being destroyed
+// at exit) is only queued, and never handed to the hooks.
+//
+
+namespace internal {
+
+namespace {
+
+size_t const releaseBatchSize = 256;
+
+struct PendingReleases {
+    RenEngineHandle engine;
+    std::vector<ReleasedCell> cells;
+};
+
+struct ReleaseQueueState {
+    std::mutex mutex;
+    std::vector<PendingReleases> pending;
+    std::atomic<size_t> lost {0};
+};
+
+// Same reasoning as for the pool state: Values in globals may release into
+// this after everything else in the file is gone.
+
+ReleaseQueueState & queueState() {
+    static ReleaseQueueState * state = new ReleaseQueueState;
+    return *state;
+}
+
+PendingReleases * findPending(
+    ReleaseQueueState & queue, RenEngineHandle engine
+) {
+    for (auto & entry : queue.pending) {
+        if (entry.engine.data == engine.data)
+            return &entry;
+    }
+    return nullptr;
+}
+
+RenResult flushPending(PendingReleases & entry) {
+    if (entry.cells.empty())
+        return REN_SUCCESS;
+
+    RenResult result = ::RenReleaseCells(
+        entry.engine,
+        &entry.cells.data()->cell,
+        entry.cells.size(),
+        sizeof(ReleasedCell)
+    );
+    entry.cells.clear();
+    return result;
+}
+
+} // end anonymous namespace
+
+
+//
+// This is called from destructors and move assignment, so it mustn't throw.
+// If the cell can't be queued (there's no memory to grow the buffer), its
+// root is never released and the series stays alive.  That is counted, so
+// tests can check that it didn't happen.
+//
+
+void ReleaseQueue::defer(
+    RenEngineHandle engine,
+    RenCell const & cell,
+    RefcountType * refcountPtr
+) noexcept {
+    auto & queue = queueState();
+
+    try {
+        size_t rootIndex = RefcountPool::rootIndex(refcountPtr);
+        RefcountPool::release(refcountPtr);
+
+        PoolLock lock {queue.mutex};
+
+        PendingReleases * entry = findPending(queue, engine);
+        if (not entry) {
+            queue.pending.push_back(PendingReleases {engine, {}});
+            entry = &queue.pending.back();
+            entry->cells.reserve(releaseBatchSize);
+        }
+
+        entry->cells.push_back(ReleasedCell {cell, rootIndex});
+    }
+    catch (std::exception const &) {
+        queue.lost++;
+    }
+}
+
+
+void ReleaseQueue::flushIfFull(RenEngineHandle engine) {
+    auto & queue = queueState();
+    PoolLock lock {queue.mutex};
+
+    PendingReleases * entry = findPending(queue, engine);
+    if (not entry or entry->cells.size() < releaseBatchSize)
+        return;
+
+    if (flushPending(*entry) != REN_SUCCESS) {
+        throw std::runtime_error(
+            "Refcounting problem reported by the Ren binding hook"
+        );
+    }
+}
+
+
+void ReleaseQueue::forget(RenEngineHandle engine) {
+    auto & queue = queueState();
+    PoolLock lock {queue.mutex};
+
+    for (auto it = queue.pending.begin(); it != queue.pending.end(); it++) {
+        if (it->engine.data == engine.data) {
+            queue.pending.erase(it);
+            return;
+        }
+    }
+}
+
+
+RenResult ReleaseQueue::flush(RenEngineHandle engine) {
+    auto & queue = queueState();
+    PoolLock lock {queue.mutex};
+
+    PendingReleases * entry = findPending(queue, engine);
+    if (not entry)
+        return REN_SUCCESS;
+
+    return flushPending(*entry);
+}
+
+
+size_t ReleaseQueue::lost() {
+    return queueState().lost;
+}
+
+
+size_t ReleaseQueue::pending(RenEngineHandle engine) {
+    auto & queue = queueState();
+    PoolLock lock {queue.mutex};
+
+    PendingReleases * entry = findPending(queue, engine);
+    return entry ? entry->cells.size() : 0;
+}
+
+} // end namespace internal
+
+
 bool Value::needsRefcount() const {
     return Runtime::needsRefcount(cell);
 }
@@ -36,14 +392,23 @@ bool Value::needsRefcount() const {
 
 // Even if asked not to initialize, we can't leave the type in a state where
 // it cannot be safely freed.  A bad refcount pointer combined with bad data
-// would be a problem.  Review this issue.
+// would be a problem.  Review this issue.  The origin is cleared too, so a
+// copy made before finishInit() can't mistake the value for a borrowed one.
 
 Value::Value (Dont const &) :
-    refcountPtr {nullptr}
+    refcountPtr {nullptr},
+    origin (REN_ENGINE_HANDLE_INVALID)
 {
 }
 
 
+RenEngineHandle Value::hookEngine() const {
+    if (REN_IS_ENGINE_HANDLE_INVALID(origin))
+        return Engine::runFinder().getHandle();
+    return origin;
+}
+
+
 
 Value::operator bool() const {
     if (isUnset()) {
@@ -58,102 +423,129 @@ Value::operator bool() const {
 
 
 
-#if REN_CLASSLIB_STD
-std::string to_string(Value const & value) {
-    const size_t defaultBufLen = 100;
-
-    std::vector<char> buffer (defaultBufLen);
+namespace {
 
-    size_t numBytes;
+//
+// Forming used to guess at a buffer size and form again if it was too
+// small, which for big values meant molding and encoding twice.  Now the
+// hook forms once and hands the UTF-8 to a sink, which appends it to
+// wherever it's going.  An exception thrown while appending is carried
+// back over the hook and rethrown.
+//
 
-    // Note .data() method is const on std::string.
-    //    http://stackoverflow.com/questions/7518732/
-
-    switch (
-        RenFormAsUtf8(
-            value.origin, &value.cell, buffer.data(), defaultBufLen, &numBytes
-        ))
-    {
-        case REN_SUCCESS:
-            assert(numBytes <= defaultBufLen);
-            break;
-
-        case REN_BUFFER_TOO_SMALL: {
-            assert(numBytes > defaultBufLen);
-            buffer.resize(numBytes);
-
-            size_t numBytesNew;
-            if (
-                RenFormAsUtf8(
-                    value.origin,
-                    &value.cell,
-                    buffer.data(),
-                    numBytes,
-                    &numBytesNew
-                ) != REN_SUCCESS
-            ) {
-                throw std::runtime_error("Expansion failure in RenFormAsUtf8");
-            }
-            assert(numBytesNew == numBytes);
-            break;
+template <class F, class H>
+void formThroughSink(F && append, H && hook, char const * hookName) {
+    struct State {
+        F & append;
+        std::exception_ptr error;
+    };
+    State state {append, nullptr};
+
+    RenUtf8SinkPointer sink = [](
+        void * statePtr, char const * data, size_t numBytes
+    ) -> RenResult {
+        State & state = *static_cast<State *>(statePtr);
+        try {
+            state.append(data, numBytes);
+        }
+        catch (...) {
+            state.error = std::current_exception();
+            return REN_BUFFER_TOO_SMALL;
         }
+        return REN_SUCCESS;
+    };
 
-        default:
-            throw std::runtime_error("Unknown error in RenFormAsUtf8");
-    }
+    RenResult result = hook(sink, static_cast<void *>(&state));
 
-    auto result = std::string(buffer.data(), numBytes);
-    return result;
+    if (state.error)
+        std::rethrow_exception(state.error);
+
+    if (result != REN_SUCCESS)
+        throw std::runtime_error(std::string {"Unknown error in "} + hookName);
 }
-#endif
 
 
-#if REN_CLASSLIB_QT
-QString to_QString(Value const & value) {
-    const size_t defaultBufLen = 100;
+template <class F>
+void formAsUtf8(RenEngineHandle engine, RenCell const & cell, F && append) {
+    char buffer[internal::formImmediateMax];
+    size_t numBytes;
+    if (internal::formImmediate(cell, buffer, numBytes)) {
+        append(static_cast<char const *>(buffer), numBytes);
+        return;
+    }
+
+    formThroughSink(
+        append,
+        [&](RenUtf8SinkPointer sink, void * state) {
+            return RenFormAsUtf8Sink(engine, &cell, sink, state);
+        },
+        "RenFormAsUtf8Sink"
+    );
+}
 
-    QByteArray buffer (defaultBufLen, Qt::Uninitialized);
 
+template <class F>
+void formAsUtf8Part(
+    RenEngineHandle engine,
+    RenCell const & cell,
+    size_t maxBytes,
+    bool * truncated,
+    F && append
+) {
+    char buffer[internal::formImmediateMax];
     size_t numBytes;
+    if (internal::formImmediate(cell, buffer, numBytes)) {
+        size_t len = std::min(numBytes, maxBytes);
+        while (len != 0 and len < numBytes and (buffer[len] & 0xC0) == 0x80)
+            len--; // don't split a character's bytes
+        if (truncated)
+            *truncated = (len < numBytes);
+        append(static_cast<char const *>(buffer), len);
+        return;
+    }
 
-    // Note .data() method is const on std::string.
-    //    http://stackoverflow.com/questions/7518732/
-
-    switch (
-        RenFormAsUtf8(
-            value.origin, &value.cell, buffer.data(), defaultBufLen, &numBytes
-        ))
-    {
-        case REN_SUCCESS:
-            assert(numBytes <= defaultBufLen);
-            break;
-
-        case REN_BUFFER_TOO_SMALL: {
-            assert(numBytes > defaultBufLen);
-            buffer.resize(numBytes);
-
-            size_t numBytesNew;
-            if (
-                RenFormAsUtf8(
-                    value.origin,
-                    &value.cell,
-                    buffer.data(),
-                    numBytes,
-                    &numBytesNew
-                ) != REN_SUCCESS
-            ) {
-                throw std::runtime_error("Expansion failure in RenFormAsUtf8");
-            }
-            assert(numBytesNew == numBytes);
-            break;
+    int wasTruncated = 0;
+    formThroughSink(
+        append,
+        [&](RenUtf8SinkPointer sink, void * state) {
+            return RenFormAsUtf8Part(
+                engine, &cell, maxBytes, sink, state, &wasTruncated
+            );
+        },
+        "RenFormAsUtf8Part"
+    );
+    if (truncated)
+        *truncated = (wasTruncated != 0);
+}
+
+} // end anonymous namespace
+
+
+#if REN_CLASSLIB_STD
+std::string to_string(Value const & value) {
+    std::string result;
+    formAsUtf8(
+        value.hookEngine(),
+        value.cell,
+        [&result](char const * data, size_t numBytes) {
+            result.append(data, numBytes);
         }
+    );
+    return result;
+}
+#endif
 
-        default:
-            throw std::runtime_error("Unknown error in RenFormAsUtf8");
-    }
 
-    buffer.truncate(numBytes);
-    auto result = QString {buffer};
+#if REN_CLASSLIB_QT
+QString to_QString(Value const & value) {
+    QString result;
+    formAsUtf8(
+        value.hookEngine(),
+        value.cell,
+        [&result](char const * data, size_t numBytes) {
+            result += QString::fromUtf8(data, static_cast<int>(numBytes));
+        }
+    );
     return result;
 }
 
@@ -168,9 +560,69 @@ String::operator QString () const {
 #endif
 
 
+void formTo(Sink const & sink, Value const & value) {
+    formAsUtf8(value.hookEngine(), value.cell, sink);
+}
+
+
+#if REN_CLASSLIB_STD
+std::string to_string(
+    Value const & value, size_t maxBytes, bool * truncated
+) {
+    std::string result;
+    formAsUtf8Part(
+        value.hookEngine(),
+        value.cell,
+        maxBytes,
+        truncated,
+        [&result](char const * data, size_t numBytes) {
+            result.append(data, numBytes);
+        }
+    );
+    return result;
+}
+#endif
+
+
+#if REN_CLASSLIB_QT
+QString to_QString(
+    Value const & value, size_t maxBytes, bool * truncated
+) {
+    QString result;
+    formAsUtf8Part(
+        value.hookEngine(),
+        value.cell,
+        maxBytes,
+        truncated,
+        [&result](char const * data, size_t numBytes) {
+            result += QString::fromUtf8(data, static_cast<int>(numBytes));
+        }
+    );
+    return result;
+}
+#endif
+
+
+void formTo(
+    Sink const & sink,
+    Value const & value,
+    size_t maxBytes,
+    bool * truncated
+) {
+    formAsUtf8Part(value.hookEngine(), value.cell, maxBytes, truncated, sink);
+}
+
+
 std::ostream & operator<<(std::ostream & os, ren::Value const & value)
 {
-    return os << to_string(value);
+    formAsUtf8(
+        value.hookEngine(),
+        value.cell,
+        [&os](char const * data, size_t numBytes) {
+            os.write(data, static_cast<std::streamsize>(numBytes));
+        }
+    );
+    return os;
 }
 
 
@@ -199,6 +651,37 @@ AnyBlock::AnyBlock (
 }
 
 
+//
+// An array of Values is handed to the hook as a strided array of their
+// cells, so no Loadable has to be made for each one.
+//
+
+AnyBlock::AnyBlock (
+    Value const values[],
+    size_t numValues,
+    internal::CellFunction cellfun,
+    Context * context
+) :
+    AnyBlock (Dont::Initialize)
+{
+    (this->*cellfun)(&this->cell);
+
+    if (not context)
+        context = &Context::runFinder(nullptr);
+
+    constructOrApplyInitialize(
+        context->getEngine().getHandle(),
+        context->getHandle(),
+        nullptr,
+        numValues != 0 ? &values[0].cell : nullptr,
+        numValues,
+        sizeof(Value),
+        this, // Do construct
+        nullptr // Don't apply
+    );
+}
+
+
 AnyWord::AnyWord (
     char const * spelling,
     internal::CellFunction cellfun,
@@ -399,29 +882,116 @@ void Value::constructOrApplyInitialize(
     Value * constructOutTypeIn,
     Value * applyOut
 ) {
+    constructOrApplyInitialize(
+        engine,
+        context,
+        applicand,
+        numLoadables != 0 ? &loadables[0].cell : nullptr,
+        numLoadables,
+        sizeof(internal::Loadable),
+        constructOutTypeIn,
+        applyOut
+    );
+}
+
+
+void Value::constructOrApplyInitialize(
+    RenEngineHandle engine,
+    RenContextHandle context,
+    Value const * applicand,
+    RenCell const * loadablesCells,
+    size_t numLoadables,
+    size_t sizeofLoadable,
+    Value * constructOutTypeIn,
+    Value * applyOut
+) {
+    // This is an evaluation boundary, so hand back everything C++ let go of
+    // since the last one before the runtime gets a chance to collect.
+
+    if (internal::ReleaseQueue::flush(engine) != REN_SUCCESS) {
+        throw std::runtime_error(
+            "Refcounting problem reported by the Ren binding hook"
+        );
+    }
+
     Value errorOut {Value::Dont::Initialize};
 
     auto result = ::RenConstructOrApply(
         engine,
         context,
         &applicand->cell,
-        numLoadables != 0 ? &loadables[0].cell : nullptr,
+        numLoadables != 0 ? loadablesCells : nullptr,
         numLoadables,
-        sizeof(internal::Loadable),
+        sizeofLoadable,
         constructOutTypeIn ? &constructOutTypeIn->cell : nullptr,
         applyOut ? &applyOut->cell : nullptr,
         &errorOut.cell
     );
 
-    switch (result) {
-        case REN_SUCCESS:
-            break;
+    if (result != REN_SUCCESS)
+        throwHookError(result, engine, errorOut, "RenConstructOrApply");
+
+    // It used to be required that we finalize the values before throwing
+    // errors because (for instance) the refcount could be initialized.
+    // That had to be changed because a Dont::Initialize was could construct
+    // a type that could not survive an exception being thrown.  So we will
+    // keep this finalization here just in case, because it should be safe now
+    // to skip it in the case of an exception.
+
+    if (constructOutTypeIn)
+        constructOutTypeIn->finishInit(engine);
+
+    if (applyOut)
+        applyOut->finishInit(engine);
+}
+
+
+Value Value::applyCells_(
+    internal::Loadable const loadables[],
+    size_t numLoadables
+) const {
+    RenEngineHandle engine = hookEngine();
+
+    // An evaluation boundary, as in constructOrApplyInitialize
+
+    if (internal::ReleaseQueue::flush(engine) != REN_SUCCESS) {
+        throw std::runtime_error(
+            "Refcounting problem reported by the Ren binding hook"
+        );
+    }
+
+    Value result {Dont::Initialize};
+    Value errorOut {Dont::Initialize};
+
+    auto code = ::RenApplyCells(
+        engine,
+        &cell,
+        numLoadables != 0 ? &loadables[0].cell : nullptr,
+        numLoadables,
+        sizeof(internal::Loadable),
+        &result.cell,
+        &errorOut.cell
+    );
+
+    if (code != REN_SUCCESS)
+        throwHookError(code, engine, errorOut, "RenApplyCells");
+
+    result.finishInit(engine);
+    return result;
+}
+
 
+void Value::throwHookError(
+    RenResult result,
+    RenEngineHandle engine,
+    Value & errorOut,
+    char const * hookName
+) {
+    switch (result) {
         case REN_CONSTRUCT_ERROR:
         case REN_APPLY_ERROR:
             errorOut.finishInit(engine);
             throw evaluation_error(errorOut);
-            break;
 
         case REN_EVALUATION_CANCELLED:
             throw evaluation_cancelled();
@@ -430,21 +1000,10 @@ void Value::constructOrApplyInitialize(
             throw exit_command(VAL_INT32(&errorOut.cell));
 
         default:
-            throw std::runtime_error("Unknown error in RenConstructOrApply");
+            throw std::runtime_error(
+                std::string {"Unknown error in "} + hookName
+            );
     }
-
-    // It used to be required that we finalize the values before throwing
-    // errors because (for instance) the refcount could be initialized.
-    // That had to be changed because a Dont::Initialize was could construct
-    // a type that could not survive an exception being thrown.  So we will
-    // keep this finalization here just in case, because it should be safe now
-    // to skip it in the case of an exception.
-
-    if (constructOutTypeIn)
-        constructOutTypeIn->finishInit(engine);
-
-    if (applyOut)
-        applyOut->finishInit(engine);
 }
 
 